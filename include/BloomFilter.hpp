@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Schema.hpp"
+
+constexpr uint32_t DEFAULT_BLOOM_BITS_PER_KEY = 10;
+
+// Blocked Bloom filter: a key maps to one 64-byte block (a cache line) and
+// sets one bit in each of the block's eight words, so a probe touches one
+// line and the eight word checks are independent (vectorizable) lanes.
+class BloomFilter {
+    private:
+        struct alignas(64) Block {
+            uint64_t words[8];
+        };
+
+        std::vector<Block> blocks;
+        uint64_t keyCount = 0;
+
+        size_t blockIndex(uint64_t hash) const;
+
+    public:
+        static constexpr size_t BLOCK_BITS = 512;
+
+        BloomFilter() = default;
+        BloomFilter(size_t expectedKeys, uint32_t bitsPerKey);
+
+        void insert(uint64_t hash);
+        bool mayContain(uint64_t hash) const;
+
+        bool empty() const;
+        uint64_t size() const;
+        size_t sizeInBytes() const;
+
+        // Expected false-positive rate for the keys inserted so far
+        double expectedFalsePositiveRate() const;
+
+        void serialize(std::vector<char>& out) const;
+        bool deserialize(const char* data, size_t size, size_t& offset);
+};
+
+struct BloomIndex {
+    bool enabled = false;
+    uint32_t keyColumn = 0;
+    uint32_t bitsPerKey = DEFAULT_BLOOM_BITS_PER_KEY;
+    BloomFilter table;
+    std::vector<BloomFilter> pages;
+};
+
+// Hash of a field's serialized encoding, so typed and dynamic rows agree
+uint64_t hashFieldBytes(const char* data, size_t size);
+// -0.0 hashes as 0.0 since the two compare equal
+uint64_t hashDouble(double value);
+uint64_t hashValue(const Value& value);
@@ -0,0 +1,49 @@
+#pragma once
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Schema.hpp"
+#include "Table.hpp"
+
+constexpr uint32_t CATALOG_MAGIC = 0x54434E4D; // "MNCT"
+// Version 2 adds each table's storage engine and LSM options
+constexpr uint32_t CATALOG_VERSION = 2;
+
+struct CatalogEntry {
+    std::string name;
+    std::string filename;
+    Schema schema;
+    StorageEngine engine = ROW_STORE;
+    LsmOptions lsmOptions;  // only used when engine == LSM
+};
+
+// Database-level list of tables. Opening a database reads only this file;
+// each table then answers metadata queries from its own header.
+class Catalog {
+    private:
+        std::string path;
+        std::vector<CatalogEntry> entries;
+
+        bool save() const;
+        bool loadEntries();
+        bool addEntry(const CatalogEntry& entry);
+
+    public:
+        explicit Catalog(const std::string& path);
+
+        bool createTable(const std::string& name, const std::string& filename, const Schema& schema);
+
+        // Creates an LSM table; openTable() reopens it with the same options
+        bool createTable(const std::string& name, const std::string& filename, const Schema& schema,
+                         const LsmOptions& options);
+
+        // Removes the catalog entry; the table file is left on disk
+        bool dropTable(const std::string& name);
+
+        std::optional<CatalogEntry> find(const std::string& name) const;
+
+        std::vector<std::string> tableNames() const;
+
+        std::unique_ptr<Table> openTable(const std::string& name);
+};
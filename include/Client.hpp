@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Protocol.hpp"
+
+// Blocking client for Server. The helpers do one round trip each; for
+// pipelining, enqueue() several requests, send() them in one write and
+// receive() the responses, which arrive in request order.
+class Client {
+    private:
+        int fd = -1;
+        uint32_t nextId = 1;
+        std::vector<char> output;
+        std::vector<char> input;
+        size_t inputOffset = 0;
+        std::deque<Opcode> pending;
+
+        bool readFrame(size_t& frameSize);
+
+        std::optional<Response> call(Request request);
+
+    public:
+        Client() = default;
+        ~Client();
+
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        bool connectUnix(const std::string& path);
+        bool connectTcp(const std::string& host, uint16_t port);
+        void disconnect();
+
+        // Assigns the request id and buffers the frame; returns the id or 0
+        uint32_t enqueue(Request request);
+        bool send();
+        bool receive(Response& response);
+
+        size_t pendingCount() const;
+
+        bool ping();
+        std::optional<Schema> schema(const std::string& table);
+        std::optional<uint64_t> insert(const std::string& table, const TableData& rows);
+        std::optional<TableData> get(const std::string& table, const Value& key);
+        std::optional<TableData> select(const std::string& table, const Query& query);
+        std::optional<AggregateResults> aggregate(
+            const std::string& table,
+            const std::vector<Condition>& where,
+            const std::vector<Aggregate>& aggregates
+        );
+        bool flush(const std::string& table);
+};
@@ -1,24 +1,339 @@
 #pragma once
+#include <algorithm>
+#include <map>
+#include <set>
 #include <vector>
 #include <string>
 #include <fstream>
+#include <iostream>
+#include <cstring>
+#include <functional>
 #include "Page.hpp"
+#include "PageWriter.hpp"
 #include "Schema.hpp"
+#include "TableMetadata.hpp"
+
+// Rows packed into pages by one writer thread during a full write
+constexpr size_t ROWS_PER_WRITE_TASK = 8192;
+
+// Filled pages a sequential append keeps before writing them out together
+constexpr size_t APPEND_BATCH_PAGES = 64;
 
 class FileManager {
   private:
-    size_t serializeRow(const Row& row, char* buffer, size_t bufferSize);
+    // Data file path for batched page writes; without one pages go through the fstream
+    std::string path;
 
-    size_t deserializeRow(const char* buffer, size_t bufferSize, const Schema& schema,Row& row);
+    // Pages packed by one write task, in row order
+    struct PageChunk {
+        PageBuffer pages;
+        std::vector<PageInfo> infos;
+        std::vector<std::vector<uint64_t>> hashes;
+        size_t skippedRows = 0;
+        bool allocFailed = false;
+    };
+
+    static uint64_t pageOffset(uint32_t version, size_t pageNum);
 
     void writePage(std::fstream& file, const Page& page, size_t pageNum);
 
-    bool readPage(std::fstream& file, Page& page, size_t pageNum);
+    // pages are (page number, PAGE_SIZE-aligned bytes)
+    void writeDataPages(std::fstream& file, const std::vector<std::pair<uint32_t, const char*>>& pages);
+
+    // Reads the raw page; used_bytes is PAGE_SIZE unless the layout stores a prefix
+    bool readPage(std::fstream& file, Page& page, size_t pageNum, uint32_t version);
+
+    // Reads a data page with used_bytes set from the prefix or the page directory
+    bool readDataPage(std::fstream& file, Page& page, size_t pageNum, const TableMetadata& metadata);
+
+    static void runTasks(size_t taskCount, const std::function<void(size_t)>& task);
+
+    // Sequential write in progress between beginAppend and finishAppend;
+    // `pages` holds unwritten pages from page number `firstPage` on, the
+    // open page last
+    struct AppendState {
+        Schema schema;
+        PageBuffer pages;
+        uint32_t firstPage = 1;
+        size_t used = 0;
+        std::vector<uint64_t> pageHashes;
+        std::vector<uint64_t> allHashes;
+        bool complete = true;
+    } appendState;
 
-    void writeHeader(std::fstream& file, uint32_t pageCount);
-    uint32_t readHeader(std::fstream& file);
+    void writeAppended(std::fstream& file, size_t pageCount);
+
+    void writeHeader(std::fstream& file, const TableMetadata& metadata);
+    bool readHeader(std::fstream& file, TableMetadata& metadata);
+
+    RootEntry writeBlob(std::fstream& file, uint32_t kind, uint32_t firstPage, const std::vector<char>& blob);
+    bool readBlob(std::fstream& file, const RootEntry& root, uint32_t version, std::vector<char>& blob);
+
+    // Writes the page directory and free-space map after the data pages, then the header
+    void writeMetadata(std::fstream& file, TableMetadata& metadata);
+
+    void accumulateStats(const Schema& schema, const char* row, size_t rowSize, std::vector<ColumnStats>& stats);
+
+    // Size of the serialized row at `row`, or 0 if it is truncated
+    size_t rowSpan(const Schema& schema, const char* row, size_t available) const;
+
+    uint64_t hashKeyField(const Schema& schema, uint32_t column, const char* row) const;
+
+    void addPageFilter(TableMetadata& metadata, std::vector<uint64_t>& pageHashes, std::vector<uint64_t>& allHashes);
+    void buildTableFilter(TableMetadata& metadata, const std::vector<uint64_t>& allHashes);
+
+    // Recomputes the filters of pages rewritten by an incremental flush and
+    // adds newly placed keys to the table filter
+    void refreshFilters(
+        std::fstream& file,
+        const Schema& schema,
+        const std::map<uint32_t, Page>& pages,
+        const std::vector<uint64_t>& newHashes,
+        TableMetadata& metadata
+    );
 
   public:
-    void write(std::fstream& file, const TableData& tableData);
-    void read(std::fstream& file, const Schema& schema, TableData& tableData);
+    FileManager() = default;
+
+    explicit FileManager(const std::string& path);
+
+    size_t serializeRow(const Row& row, char* buffer, size_t bufferSize);
+
+    size_t deserializeRow(const char* buffer, size_t bufferSize, const Schema& schema,Row& row);
+
+    // rowPages, when given, receives the page each row was placed on or read from.
+    // write returns false if a row was skipped or the file could not be written.
+    bool write(
+        std::fstream& file,
+        const Schema& schema,
+        const TableData& tableData,
+        TableMetadata& metadata,
+        std::vector<uint32_t>* rowPages = nullptr
+    );
+    void read(
+        std::fstream& file,
+        const Schema& schema,
+        TableData& tableData,
+        TableMetadata& metadata,
+        std::vector<uint32_t>* rowPages = nullptr
+    );
+
+    // Full write of rows produced one at a time, e.g. by a merge. Pages go out
+    // in batches as they fill, so memory stays at a few pages plus the page
+    // directory and key hashes. Bloom settings in metadata are kept.
+    // finishAppend returns false like write().
+    void beginAppend(std::fstream& file, const Schema& schema, TableMetadata& metadata);
+    bool append(std::fstream& file, const Row& row, TableMetadata& metadata);
+    bool finishAppend(std::fstream& file, TableMetadata& metadata);
+
+    // True when metadata carries the page directory needed by writeIncremental
+    bool supportsIncremental(const TableMetadata& metadata) const;
+
+    // True when writeIncremental is possible and cheaper than write(): some
+    // pages are on disk and at most half the rows (rowPages entry 0) still
+    // need placing. Otherwise the parallel full write wins.
+    bool preferIncremental(const TableMetadata& metadata, const std::vector<uint32_t>& rowPages) const;
+
+    // Rewrites only dirtyPages and places rows with page 0 into pages the
+    // free-space map reports room in, appending pages only when none has.
+    // rowPages is updated with the new placements. False if the page buffer
+    // could not be allocated: nothing is written, and metadata must be
+    // rebuilt by a full write().
+    bool writeIncremental(
+        std::fstream& file,
+        const Schema& schema,
+        const TableData& tableData,
+        std::vector<uint32_t>& rowPages,
+        const std::set<uint32_t>& dirtyPages,
+        TableMetadata& metadata
+    );
+
+    // Reads the header and page directory only, never the data pages
+    bool readMetadata(std::fstream& file, TableMetadata& metadata);
+
+    // metadata must come from readMetadata on the same file
+    bool readPageRows(
+        std::fstream& file,
+        const Schema& schema,
+        const TableMetadata& metadata,
+        uint32_t pageNum,
+        TableData& rows
+    );
+
+    // Page packing shared by every row representation. `serialize(i, buffer, size)`
+    // encodes row i and returns its size (0 if it does not fit); it is called
+    // from several threads at once for large tables, each on different rows.
+    // `deserialize(buffer, size, pageNum)` decodes one row and returns the
+    // bytes consumed (0 stops the page). Returns false like write(), and also
+    // when the page buffers could not be allocated; the file and metadata are
+    // left untouched then.
+    template <typename Serialize>
+    bool writeRows(
+        std::fstream& file,
+        const Schema& schema,
+        size_t rowCount,
+        Serialize&& serialize,
+        TableMetadata& metadata,
+        std::vector<uint32_t>* rowPages = nullptr
+    );
+
+    template <typename Deserialize>
+    void readRows(std::fstream& file, TableMetadata& metadata, Deserialize&& deserialize);
+
+    // readRows without the header read; metadata must come from readMetadata
+    // on the same file, e.g. after the caller has checked its schema
+    template <typename Deserialize>
+    void readDataRows(std::fstream& file, const TableMetadata& metadata, Deserialize&& deserialize);
 };
+
+template <typename Serialize>
+bool FileManager::writeRows(
+    std::fstream& file,
+    const Schema& schema,
+    size_t rowCount,
+    Serialize&& serialize,
+    TableMetadata& metadata,
+    std::vector<uint32_t>* rowPages)
+{
+    file.clear();
+    
+    BloomIndex bloom;
+    bloom.enabled = metadata.bloom.enabled;
+    bloom.keyColumn = metadata.bloom.keyColumn;
+    bloom.bitsPerKey = metadata.bloom.bitsPerKey;
+    
+    std::vector<uint64_t> allHashes;
+    
+    if (rowPages) {
+        rowPages->assign(rowCount, 0);
+    }
+    
+    // Each task packs its own rows into its own pages, so at most one page per
+    // task is left partly empty; page numbers are assigned afterwards in order.
+    size_t taskCount = (rowCount + ROWS_PER_WRITE_TASK - 1) / ROWS_PER_WRITE_TASK;
+    std::vector<PageChunk> chunks(taskCount);
+    
+    runTasks(taskCount, [&](size_t task) {
+        PageChunk& chunk = chunks[task];
+        char* page = nullptr;
+        size_t used = 0;
+        size_t end = std::min(rowCount, (task + 1) * ROWS_PER_WRITE_TASK);
+        
+        for (size_t i = task * ROWS_PER_WRITE_TASK; i < end; i++) {
+            size_t rowSize = page ? serialize(i, page + used, PAGE_SIZE - used) : 0;
+            
+            if (rowSize == 0 && (page == nullptr || used > 0)) {
+                page = chunk.pages.append();
+                if (page == nullptr) {
+                    chunk.allocFailed = true;
+                    return;
+                }
+                used = 0;
+                chunk.infos.emplace_back();
+                chunk.infos.back().stats.resize(schema.size());
+                chunk.hashes.emplace_back();
+                rowSize = serialize(i, page, PAGE_SIZE);
+            }
+            
+            if (rowSize == 0) {
+                std::cerr << "Warning: Row too large to fit in a single page, skipping\n";
+                chunk.skippedRows++;
+                continue;
+            }
+            
+            PageInfo& info = chunk.infos.back();
+            accumulateStats(schema, page + used, rowSize, info.stats);
+            if (bloom.enabled) {
+                chunk.hashes.back().push_back(hashKeyField(schema, bloom.keyColumn, page + used));
+            }
+            
+            used += rowSize;
+            info.rowCount++;
+            info.usedBytes = used;
+            
+            if (rowPages) {
+                (*rowPages)[i] = chunk.infos.size();
+            }
+        }
+    });
+    
+    for (const auto& chunk : chunks) {
+        if (chunk.allocFailed) {
+            std::cerr << "Warning: Failed to allocate page buffer, nothing written\n";
+            // No row is placed, so the next flush is a full write again
+            if (rowPages) {
+                rowPages->assign(rowCount, 0);
+            }
+            return false;
+        }
+    }
+    
+    metadata = TableMetadata();
+    metadata.schema = schema;
+    metadata.bloom = bloom;
+    
+    std::vector<std::pair<uint32_t, const char*>> pages;
+    bool complete = true;
+    for (size_t task = 0; task < taskCount; task++) {
+        PageChunk& chunk = chunks[task];
+        uint32_t base = metadata.pages.size();
+        complete = complete && chunk.skippedRows == 0;
+        
+        if (rowPages) {
+            size_t end = std::min(rowCount, (task + 1) * ROWS_PER_WRITE_TASK);
+            for (size_t i = task * ROWS_PER_WRITE_TASK; i < end; i++) {
+                if ((*rowPages)[i] != 0) (*rowPages)[i] += base;
+            }
+        }
+        
+        for (size_t p = 0; p < chunk.infos.size(); p++) {
+            // Only an unplaceable last row leaves a page empty
+            if (chunk.infos[p].rowCount == 0) continue;
+            metadata.pages.push_back(std::move(chunk.infos[p]));
+            addPageFilter(metadata, chunk.hashes[p], allHashes);
+            pages.push_back({metadata.pages.size(), chunk.pages.page(p)});
+        }
+    }
+    
+    writeDataPages(file, pages);
+    buildTableFilter(metadata, allHashes);
+    writeMetadata(file, metadata);
+    
+    file.flush();
+    return complete && file.good();
+}
+
+template <typename Deserialize>
+void FileManager::readRows(std::fstream& file, TableMetadata& metadata, Deserialize&& deserialize) {
+    if (!readMetadata(file, metadata)) {
+        return;
+    }
+    
+    readDataRows(file, metadata, deserialize);
+}
+
+template <typename Deserialize>
+void FileManager::readDataRows(std::fstream& file, const TableMetadata& metadata, Deserialize&& deserialize) {
+    for (uint32_t pageNum = 1; pageNum <= metadata.pageCount; pageNum++) {
+        Page currentPage;
+        
+        if (!readDataPage(file, currentPage, pageNum, metadata)) {
+            std::cerr << "Warning: Failed to read page " << pageNum << "\n";
+            continue;
+        }
+        
+        size_t offset = 0;
+        
+        while (offset < currentPage.used_bytes) {
+            size_t bytesRead = deserialize(
+                currentPage.getReadPtr(offset),
+                currentPage.used_bytes - offset,
+                pageNum
+            );
+            
+            if (bytesRead == 0) break;
+            
+            offset += bytesRead;
+        }
+    }
+}
\ No newline at end of file
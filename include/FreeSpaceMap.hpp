@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "Page.hpp"
+
+// One byte per data page recording how much of it is free, in units of
+// PAGE_SIZE / 256. Levels round down, so a page found for n bytes always
+// has room for them.
+class FreeSpaceMap {
+    private:
+        std::vector<uint8_t> levels;
+        // Max-tree over levels so findPage is O(log n): node i holds the
+        // larger of nodes 2i and 2i+1, and leaf `leaves + k` is page k + 1.
+        // Leaves past the last page stay 0.
+        std::vector<uint8_t> tree;
+        size_t leaves = 0;
+
+        void rebuild();
+        void update(size_t index);
+
+    public:
+        static constexpr size_t BYTES_PER_LEVEL = PAGE_SIZE / 256;
+
+        void resize(size_t pageCount);
+        void clear();
+        size_t pageCount() const;
+
+        // pageNum is 1-based, matching FileManager page numbers
+        void setFreeBytes(uint32_t pageNum, size_t freeBytes);
+        size_t freeBytes(uint32_t pageNum) const;
+
+        // First page with at least bytesNeeded free, if any
+        std::optional<uint32_t> findPage(size_t bytesNeeded) const;
+
+        std::vector<char> serialize() const;
+        void deserialize(const std::vector<char>& bytes);
+};
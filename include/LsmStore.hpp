@@ -0,0 +1,185 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BloomFilter.hpp"
+#include "FileManager.hpp"
+#include "Schema.hpp"
+#include "TableMetadata.hpp"
+
+constexpr uint32_t LSM_MANIFEST_MAGIC = 0x534C4E4D; // "MNLS"
+constexpr uint32_t LSM_MANIFEST_VERSION = 1;
+
+struct LsmOptions {
+    size_t keyColumn = 0;
+    size_t memtableBytes = 4 * 1024 * 1024;
+    // Tiered compaction: a level holding this many runs is merged into one run on the next level
+    size_t runsPerLevel = 4;
+    uint32_t bitsPerKey = DEFAULT_BLOOM_BITS_PER_KEY;
+    bool backgroundCompaction = true;
+};
+
+struct LsmStats {
+    std::atomic<uint64_t> flushes{0};
+    std::atomic<uint64_t> compactions{0};
+    std::atomic<uint64_t> runProbes{0};
+    std::atomic<uint64_t> bloomSkips{0};
+    std::atomic<uint64_t> fenceSkips{0};
+    std::atomic<uint64_t> pageReads{0};
+};
+
+// Write-optimized engine: rows keyed on one column go to a sorted in-memory
+// memtable, which is written out as an immutable sorted run once full. Runs use
+// the regular table file format (page directory zone maps act as fence pointers,
+// the Bloom filter root as the per-run filter) plus a trailing tombstone column.
+class LsmStore {
+    private:
+        struct Entry {
+            Row row;
+            bool deleted = false;
+        };
+
+        struct Run {
+            uint64_t id;
+            std::string filename;
+            std::fstream file;
+            TableMetadata metadata;
+            std::mutex ioMutex;
+            bool obsolete = false;
+
+            ~Run();
+        };
+
+        using RunPtr = std::shared_ptr<Run>;
+        using Memtable = std::map<Value, Entry>;
+
+        // One sorted input of a merge: a run read a page at a time, or
+        // (without a run) entries copied from a memtable
+        struct MergeCursor {
+            RunPtr run;
+            uint32_t nextPage = 1;
+            std::vector<Entry> entries;
+            size_t pos = 0;
+        };
+
+        std::string path;
+        Schema schema;
+        Schema runSchema;
+        LsmOptions options;
+        FileManager fileManager;
+
+        // flushMutex serializes flushes and is always taken before mutex
+        std::mutex flushMutex;
+        mutable std::mutex mutex;
+        Memtable memtable;
+        size_t memtableBytes = 0;
+        // Memtable being written out; still served to readers until its run is installed
+        std::shared_ptr<const Memtable> flushing;
+        // levels[0] holds freshly flushed runs; each level is ordered oldest to newest
+        std::vector<std::vector<RunPtr>> levels;
+        uint64_t nextRunId = 1;
+
+        // Held for a whole compaction so inline compactions from several writers don't overlap
+        std::mutex compactionMutex;
+        std::thread compactor;
+        std::condition_variable compactionSignal;
+        std::condition_variable compactionDone;
+        bool compacting = false;
+        bool stopping = false;
+        // Set when a compaction output could not be written; its inputs stay
+        // installed and compaction pauses until the next flush succeeds
+        bool compactionFailed = false;
+
+        LsmStats stats;
+
+        bool validateRow(const Row& row) const;
+
+        // Replaces any memtable entry for key, keeping memtableBytes the size
+        // of the entries it holds; true once the memtable is full. Caller holds mutex.
+        bool storeInMemtable(const Value& key, Entry entry);
+        std::string runFilename(uint64_t id) const;
+
+        // Without openRuns the listed run files are deleted instead
+        bool loadManifest(bool openRuns);
+        bool saveManifest() const;
+
+        RunPtr openRun(uint64_t id);
+
+        // Writes rows (with the tombstone column) from next() until it returns
+        // false; nullptr if the run could not be written completely
+        RunPtr writeRun(const std::function<bool(Row&)>& next);
+
+        // Loads the cursor's next page once its entries are used up; false on a read error
+        bool fillCursor(MergeCursor& cursor);
+
+        // Next entry in key order of the k-way merge of cursors, which are
+        // ordered oldest to newest; only the newest version of a key is
+        // returned. False at the end, or on a read error, which sets failed.
+        bool nextMerged(std::vector<MergeCursor>& cursors, Entry& entry, bool& failed);
+
+        // Cursors over every run and both memtables, oldest first
+        std::vector<MergeCursor> allCursors() const;
+
+        void flushMemtable(bool onlyIfFull);
+
+        // Looks key up in one run: Bloom filter, then fence pointers, then one page
+        std::optional<Entry> searchRun(Run& run, const Value& key, uint64_t hash);
+
+        int levelNeedingCompaction() const;
+        // False if the merged run could not be written; nothing is changed then
+        bool compactLevel(size_t level);
+        void compactionLoop();
+
+    public:
+        LsmStore(const std::string& path, std::ios::openmode mode, const Schema& schema, const LsmOptions& options);
+        ~LsmStore();
+
+        LsmStore(const LsmStore&) = delete;
+        LsmStore& operator=(const LsmStore&) = delete;
+
+        // Inserts or replaces the row with the same key
+        bool put(const Row& row);
+
+        bool remove(const Value& key);
+
+        std::optional<Row> get(const Value& key);
+
+        // Every live row in key order
+        TableData scan();
+
+        // Streams live rows in key order, reading one page per run at a time,
+        // until visit returns false; false on a read error
+        bool scan(const std::function<bool(const Row&)>& visit);
+
+        // Live rows, counted by merging every run without keeping any rows
+        size_t rowCount();
+
+        // Stored versions and tombstones in runs and memtables; an upper
+        // bound on rowCount() that needs no I/O
+        uint64_t entryCount() const;
+
+        // Writes the memtable out as a level-0 run
+        void flush();
+
+        // Runs compaction until no level is over its run limit; false if a
+        // compaction failed and left its level as it was
+        bool compact();
+
+        void waitForCompaction();
+
+        std::vector<size_t> levelSizes() const;
+
+        const LsmStats& getStats() const;
+
+        const Schema& getSchema() const;
+
+        size_t getKeyColumn() const;
+};
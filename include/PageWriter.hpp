@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Page.hpp"
+
+// Heap memory holding whole pages, each aligned to PAGE_SIZE as O_DIRECT
+// requires. New pages are zero-filled so no stale memory reaches the disk.
+class PageBuffer {
+    private:
+        char* pages = nullptr;
+        size_t count = 0;
+        size_t capacity = 0;
+
+    public:
+        PageBuffer() = default;
+        ~PageBuffer();
+
+        PageBuffer(PageBuffer&& other) noexcept;
+        PageBuffer& operator=(PageBuffer&& other) noexcept;
+        PageBuffer(const PageBuffer&) = delete;
+        PageBuffer& operator=(const PageBuffer&) = delete;
+
+        char* append();
+
+        char* page(size_t index) { return pages + index * PAGE_SIZE; }
+        const char* page(size_t index) const { return pages + index * PAGE_SIZE; }
+
+        size_t pageCount() const { return count; }
+};
+
+// Batches page-sized writes to one file. Runs of consecutive pages go out in
+// single pwritev calls, opened with O_DIRECT when the filesystem allows it so
+// large flushes do not push hot pages out of the page cache. isOpen() is false
+// off Linux or without a path; callers then write through their fstream.
+class PageWriter {
+    private:
+        int fd = -1;
+        bool direct = false;
+        // (byte offset, PAGE_SIZE-aligned page) in the order added
+        std::vector<std::pair<uint64_t, const char*>> queued;
+
+    public:
+        explicit PageWriter(const std::string& path);
+        ~PageWriter();
+
+        PageWriter(const PageWriter&) = delete;
+        PageWriter& operator=(const PageWriter&) = delete;
+
+        bool isOpen() const;
+        bool usesDirectIo() const;
+
+        // The page must stay valid until flush()
+        void add(uint64_t offset, const char* page);
+
+        bool flush();
+};
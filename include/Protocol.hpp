@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Query.hpp"
+#include "Schema.hpp"
+
+// Frame layout, little-endian like the table files:
+//   u32 length of the rest of the frame
+//   u32 request id (echoed in the response)
+//   u8  opcode (request) or status (response)
+//   payload
+// Rows are sent as u32 column count, one type byte per column, u32 row count
+// and the rows back to back in FileManager::serializeRow encoding.
+constexpr size_t FRAME_HEADER_SIZE = 2 * sizeof(uint32_t) + 1;
+constexpr uint32_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+enum Opcode : uint8_t {OP_PING = 1, OP_SCHEMA, OP_INSERT, OP_GET, OP_SELECT, OP_AGGREGATE, OP_FLUSH};
+
+enum Status : uint8_t {STATUS_OK = 0, STATUS_ERROR = 1};
+
+struct Request {
+    uint32_t id = 0;
+    Opcode op = OP_PING;
+    std::string table;
+    TableData rows;                     // INSERT: many rows per request
+    Value key;                          // GET: equality on the table's key column
+    Query query;                        // SELECT; AGGREGATE uses query.where
+    std::vector<Aggregate> aggregates;  // AGGREGATE
+};
+
+struct Response {
+    uint32_t id = 0;
+    Status status = STATUS_OK;
+    std::string error;
+    Schema schema;             // SCHEMA
+    TableData rows;            // GET, SELECT
+    uint64_t count = 0;        // INSERT: rows accepted
+    AggregateResults values;   // AGGREGATE
+};
+
+enum FrameState {FRAME_INCOMPLETE, FRAME_READY, FRAME_INVALID};
+
+// Checks whether data starts with a whole frame; frameSize includes the length prefix
+FrameState nextFrame(const char* data, size_t size, size_t& frameSize);
+
+// Append one frame to out, so pipelined requests can share a single write
+bool encodeRequest(const Request& request, std::vector<char>& out);
+bool encodeResponse(const Response& response, Opcode op, std::vector<char>& out);
+
+// frame points at the length prefix of a frame accepted by nextFrame
+bool decodeRequest(const char* frame, size_t frameSize, Request& request);
+bool decodeResponse(const char* frame, size_t frameSize, Opcode op, Response& response);
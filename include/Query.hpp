@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include "Schema.hpp"
+#include "TableMetadata.hpp"
+
+enum CompareOp {CMP_EQ, CMP_NE, CMP_LT, CMP_LE, CMP_GT, CMP_GE};
+
+// row[column] <op> value; value must have the column's type
+struct Condition {
+    size_t column;
+    CompareOp op;
+    Value value;
+};
+
+// Rows matching every condition, projected onto `columns` (empty = all
+// columns), at most `limit` of them (0 = no limit)
+struct Query {
+    std::vector<Condition> where;
+    std::vector<size_t> columns;
+    size_t limit = 0;
+};
+
+enum AggregateOp {AGG_COUNT, AGG_SUM, AGG_MIN, AGG_MAX, AGG_AVG};
+
+// COUNT ignores the column; SUM and AVG need a numeric column
+struct Aggregate {
+    AggregateOp op;
+    size_t column;
+};
+
+// COUNT is an int, SUM and AVG are doubles, MIN and MAX have the column's
+// type. Everything but COUNT is empty when no row matched.
+using AggregateResults = std::vector<std::optional<Value>>;
+
+bool validConditions(const Schema& schema, const std::vector<Condition>& where);
+
+bool validQuery(const Schema& schema, const Query& query);
+
+bool validAggregates(const Schema& schema, const std::vector<Aggregate>& aggregates);
+
+bool matches(const std::vector<Condition>& where, const Row& row);
+
+// False only when the zone map proves no row of the page can match
+bool mayMatch(const std::vector<Condition>& where, const std::vector<ColumnStats>& stats);
+
+Row project(const Row& row, const std::vector<size_t>& columns);
+
+Schema projectSchema(const Schema& schema, const std::vector<size_t>& columns);
+
+// Canonical byte keys for result caching; equal keys mean equal results
+std::string queryKey(const Query& query);
+
+std::string aggregateKey(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates);
+
+// SUM accumulator that does not depend on the order of adds and removes:
+// INT values add up exactly in 64 bits, DOUBLE values are kept as
+// non-overlapping partials (Shewchuk) whose total is exact until value()
+// rounds it once. Subtracting a value is then exact too, so a view that saw
+// deletes reports the same sum as a fresh scan.
+class ExactSum {
+    private:
+        int64_t ints = 0;
+        std::vector<double> partials;
+        size_t nans = 0, positiveInfs = 0, negativeInfs = 0;
+
+        void addDouble(double x, int sign);
+
+    public:
+        void add(const Value& value);
+        void remove(const Value& value);
+        void clear();
+        double value() const;
+};
+
+class Aggregator {
+    private:
+        std::vector<Aggregate> aggregates;
+        size_t count = 0;
+        std::vector<ExactSum> sums;
+        std::vector<std::optional<Value>> extremes;
+
+    public:
+        explicit Aggregator(const std::vector<Aggregate>& aggregates);
+
+        void add(const Row& row);
+
+        AggregateResults results() const;
+};
+
+// Aggregates over the rows matching `where`, kept current as rows are added
+// and removed. MIN and MAX keep every matching value so a delete costs
+// O(log n) instead of a rescan.
+class AggregateView {
+    private:
+        std::vector<Condition> where;
+        std::vector<Aggregate> aggregates;
+        size_t count = 0;
+        std::vector<ExactSum> sums;
+        std::vector<std::multiset<Value>> values;
+
+    public:
+        AggregateView(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates);
+
+        const std::vector<Condition>& getWhere() const;
+        const std::vector<Aggregate>& getAggregates() const;
+
+        // Rows not matching `where` are ignored
+        void add(const Row& row);
+        void remove(const Row& row);
+
+        void clear();
+
+        // Same types as Aggregator::results()
+        AggregateResults results() const;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "Query.hpp"
+
+constexpr size_t DEFAULT_RESULT_CACHE_ENTRIES = 64;
+
+struct ResultCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+// Least-recently-used results keyed by queryKey()/aggregateKey(). Each entry
+// remembers the table version it was computed at and is only returned for
+// that version, so writers never have to find the entries they invalidate.
+// Safe to use from concurrent readers.
+class ResultCache {
+    private:
+        struct Entry {
+            std::string key;
+            uint64_t version;
+            TableData rows;
+            AggregateResults values;
+        };
+
+        mutable std::mutex mutex;
+        // Most recently used first
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        size_t capacity;
+        ResultCacheStats stats;
+
+        Entry* find(const std::string& key, uint64_t version);
+        Entry& store(const std::string& key, uint64_t version);
+
+    public:
+        explicit ResultCache(size_t capacity = DEFAULT_RESULT_CACHE_ENTRIES);
+
+        std::optional<TableData> getRows(const std::string& key, uint64_t version);
+        void putRows(const std::string& key, uint64_t version, const TableData& rows);
+
+        std::optional<AggregateResults> getValues(const std::string& key, uint64_t version);
+        void putValues(const std::string& key, uint64_t version, const AggregateResults& values);
+
+        // 0 disables caching
+        void setCapacity(size_t entryCount);
+
+        void clear();
+
+        ResultCacheStats getStats() const;
+};
@@ -3,6 +3,10 @@
 #include <string>
 #include <optional>
 #include <functional>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include "Query.hpp"
 #include "Schema.hpp"
 
 class RowStore {
@@ -10,15 +14,61 @@ class RowStore {
         TableData table_data;
         Schema schema;
         
+        // Page each row was read from or last flushed to (0 = not on disk yet),
+        // and pages whose rows changed since the last flush
+        std::vector<uint32_t> row_pages;
+        std::set<uint32_t> dirty_pages;
+        bool placement_valid = true;
+        bool pending_inserts = false;
+        bool read_only = false;
+        
+        // Bumped on every change; untracked while mutable getData() access
+        // may have changed rows without it
+        uint64_t version = 0;
+        bool version_tracked = true;
+        
+        // Materialized aggregates by id, and ids by aggregateKey()
+        std::map<size_t, AggregateView> views;
+        std::unordered_map<std::string, size_t> view_ids;
+        size_t next_view_id = 1;
+        
+        void markDirty(size_t index);
+        
+        void addToViews(const Row& row);
+        void removeFromViews(const Row& row);
+        void rebuildViews();
+        
+        // Recounts the views when mutable access left them stale
+        void retrack();
+        
         bool validateRow(const Row& row) const;
+        
+        // Warns and returns true when writes are refused
+        bool rejectWrite() const;
 
     public:
         RowStore(const Schema& schema);
         
+        // A read-only store refuses insert, update, delete, loadData and clear
+        void setReadOnly(bool readOnly);
+        bool isReadOnly() const;
+        
+        // Mutable access bypasses change tracking, so the next flush rewrites the file
         TableData& getData();
         const TableData& getData() const;
         
         void loadData(const TableData& data);
+        void loadData(const TableData& data, const std::vector<uint32_t>& rowPages);
+        
+        const std::vector<uint32_t>& getRowPages() const;
+        const std::set<uint32_t>& getDirtyPages() const;
+        bool hasValidPlacement() const;
+        
+        // True when rows differ from what the last load or flush saw on disk
+        bool hasUnflushedChanges() const;
+        
+        // Records where a flush put each row and forgets the dirty pages
+        void markFlushed(const std::vector<uint32_t>& rowPages);
         
         void clear();
         
@@ -39,6 +89,21 @@ class RowStore {
         
         size_t deleteWhere(std::function<bool(const Row&)> predicate);
         
+        // Empty after mutable getData() until the next loadData, clear or
+        // markFlushed; results computed at an equal version are still current
+        std::optional<uint64_t> getVersion() const;
+        
+        // COUNT/SUM/MIN/MAX/AVG over rows matching where, updated by every
+        // mutation. Arguments must be valid for the schema.
+        size_t addView(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates);
+        bool dropView(size_t id);
+        
+        // View over exactly these conditions and aggregates, if one exists
+        std::optional<size_t> findView(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates) const;
+        
+        // Recomputed by a scan while the version is untracked
+        std::optional<AggregateResults> viewResults(size_t id) const;
+        
         void printAll() const;
         size_t rowCount() const;
 };
\ No newline at end of file
@@ -5,7 +5,9 @@
 
 enum SupportedTypes {INT, DOUBLE, STRING};
 
-using Row = std::vector<std::variant<int, double, std::string>>;
+using Value = std::variant<int, double, std::string>;
+
+using Row = std::vector<Value>;
 
 using TableData = std::vector<Row>;
 
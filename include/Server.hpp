@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Protocol.hpp"
+#include "Table.hpp"
+
+struct ServerOptions {
+    // Unix domain socket path; when empty the server listens on localhost TCP
+    std::string socketPath;
+    uint16_t port = 0;  // 0 picks a free port, see Server::getPort
+    // Threads executing requests; 0 runs them on the event loop thread
+    size_t workers = 4;
+    // A connection stops being read while this much of its output is unsent
+    size_t maxPendingOutput = 8 * 1024 * 1024;
+};
+
+// Serves the tables it owns over the Protocol.hpp framing. One epoll thread
+// accepts, reads and writes; complete frames of a connection are handed to the
+// worker pool as one batch, so pipelined requests run in order and their
+// responses leave in as few writes as possible.
+class Server {
+    private:
+        struct TableSlot {
+            std::unique_ptr<Table> table;
+            // Reads share it; RowStore writes and flushes take it exclusively
+            std::shared_mutex mutex;
+        };
+
+        struct Connection {
+            int fd = -1;
+            uint32_t events = 0;
+            bool closed = false;
+            // Peer shut down its side: answer what was read, then close
+            bool inputClosed = false;
+            std::vector<char> input;
+
+            // Shared with the worker running this connection's batch
+            std::mutex mutex;
+            std::deque<std::vector<char>> frames;
+            std::vector<char> output;
+            size_t outputOffset = 0;
+            bool busy = false;
+        };
+
+        using ConnectionPtr = std::shared_ptr<Connection>;
+
+        ServerOptions options;
+        std::map<std::string, std::unique_ptr<TableSlot>> tables;
+
+        int listenFd = -1;
+        int epollFd = -1;
+        int wakeFd = -1;
+        uint16_t port = 0;
+        std::atomic<bool> running{false};
+
+        std::thread loop;
+        std::map<int, ConnectionPtr> connections;  // event loop thread only
+
+        std::vector<std::thread> workers;
+        std::mutex queueMutex;
+        std::condition_variable queueSignal;
+        std::deque<ConnectionPtr> runQueue;
+        bool stopping = false;
+
+        // Connections whose batch finished, handed back to the event loop
+        std::mutex completedMutex;
+        std::vector<ConnectionPtr> completed;
+
+        bool openListener();
+        void eventLoop();
+        void workerLoop();
+        void wake();
+
+        void accept();
+        void readInput(const ConnectionPtr& conn);
+        void writeOutput(const ConnectionPtr& conn);
+        void schedule(const ConnectionPtr& conn);
+        void updateEvents(const ConnectionPtr& conn);
+        void closeConnection(const ConnectionPtr& conn);
+
+        // True once a half-closed connection has no frames left to run or send
+        bool drained(const ConnectionPtr& conn);
+
+        // Runs every queued frame of conn and appends the responses to its output
+        void process(Connection& conn);
+
+    public:
+        explicit Server(const ServerOptions& options);
+        ~Server();
+
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+        // Tables must be added before start(); RowStore tables are loaded here
+        // so concurrent reads never touch the file
+        bool addTable(const std::string& name, std::unique_ptr<Table> table);
+
+        bool start();
+
+        // Stops serving and flushes every table
+        void stop();
+
+        uint16_t getPort() const;
+
+        Response handle(const Request& request);
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <string>
+#include "Schema.hpp"
+
+constexpr size_t DEFAULT_SORT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+enum SortOrder {ASCENDING, DESCENDING};
+
+struct SortKey {
+    size_t column;
+    SortOrder order = ASCENDING;
+};
+
+using OrderBy = std::vector<SortKey>;
+
+// Receives sorted rows one at a time; the row is only valid during the call
+using RowSink = std::function<void(const Row&)>;
+
+// Produces the rows to sort by calling add once per row
+using RowSource = std::function<void(const RowSink& add)>;
+
+// Orders rows by one or more columns. Each row is reduced to a normalized
+// binary key so comparisons are a single memcmp instead of variant dispatch.
+// Resident rows (TableData) are sorted by reference. Streamed rows (RowSource)
+// are buffered up to the memory budget, spilled as sorted runs and merged, so
+// the sorter never holds much more than the budget.
+class Sorter {
+    private:
+        struct Entry {
+            std::string key;
+            size_t seq;
+        };
+
+        // A streamed row with its key, owned by the sorter until spilled
+        struct Buffered {
+            std::string key;
+            uint64_t seq;
+            Row row;
+        };
+
+        Schema schema;
+        OrderBy orderBy;
+        size_t memoryBudget;
+        std::string spillPrefix;
+
+        bool validKeys() const;
+
+        void encodeKey(const Row& row, std::string& key) const;
+
+        void sortInMemory(const TableData& rows, size_t limit, const RowSink& emit);
+
+        void topK(const TableData& rows, size_t limit, const RowSink& emit);
+
+        static size_t footprint(const Buffered& entry);
+
+        // run must already be sorted
+        bool spillRun(const std::vector<Buffered>& run, const std::string& path);
+
+    public:
+        Sorter(
+            const Schema& schema,
+            const OrderBy& orderBy,
+            size_t memoryBudget = DEFAULT_SORT_MEMORY_BUDGET,
+            const std::string& spillPrefix = "minidb"
+        );
+
+        // limit == 0 returns every row
+        TableData sort(const TableData& rows, size_t limit = 0);
+
+        // Streams the rows to emit in order instead of collecting them.
+        // Returns false (emitting nothing) for an invalid ORDER BY column.
+        bool sort(const TableData& rows, size_t limit, const RowSink& emit);
+
+        // Sorts rows that are not resident, e.g. pages read one at a time;
+        // a merge holds one row per spilled run rather than the whole result
+        bool sort(const RowSource& source, size_t limit, const RowSink& emit);
+
+        static size_t rowFootprint(const Row& row);
+};
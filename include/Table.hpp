@@ -1,9 +1,25 @@
 #pragma once
 #include <string>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include "LsmStore.hpp"
+#include "Query.hpp"
+#include "ResultCache.hpp"
 #include "RowStore.hpp"
 #include "Schema.hpp"
 #include "FileManager.hpp"
+#include "Sorter.hpp"
+#include "TableMetadata.hpp"
+
+struct BloomStats {
+    uint64_t probes = 0;
+    uint64_t negatives = 0;
+    uint64_t falsePositives = 0;
+    uint64_t probeNanos = 0;
+};
+
+enum StorageEngine {ROW_STORE, LSM};
 
 class Table {
 private:
@@ -12,16 +28,117 @@ private:
     Schema schema;
     RowStore rowStore;
     FileManager fileManager;
+    TableMetadata metadata;
+    bool loaded = false;
+    size_t sortMemoryBudget = DEFAULT_SORT_MEMORY_BUDGET;
+    BloomStats bloomStats;
+    // Set only for LSM tables; rowStore and file stay unused then
+    std::unique_ptr<LsmStore> lsm;
+    ResultCache resultCache;
+
+    void openMetadata(std::ios::openmode mode);
+
+    // Filters describe the file; they are only usable when memory matches it
+    bool filtersCurrent() const;
+
+    bool probeTableFilter(uint64_t hash);
+
+    // Version cached results are tagged with; empty when they cannot be cached
+    std::optional<uint64_t> cacheVersion() const;
+
+    // Calls visit on each row matching where until it returns false
+    void scanMatching(const std::vector<Condition>& where, const std::function<bool(const Row&)>& visit);
 
 public:
     Table(const std::string& name, std::ios::openmode mode, const Schema& schema);
+
+    // Opens an existing table, taking the schema from the file header
+    Table(const std::string& name, std::ios::openmode mode);
+
+    // LSM-backed table: name is the manifest, runs are stored next to it
+    Table(const std::string& name, std::ios::openmode mode, const Schema& schema, const LsmOptions& options);
+
     ~Table();
     
     void load();
     
     void flush();
     
+    // False while rows are answered from the file without a load()
+    bool isLoaded() const;
+
+    // Loads an unloaded table first, since the store may be mutated through
+    // the reference. LSM tables return an empty read-only store; write
+    // through insert()
     RowStore& getRowStore();
+
+    StorageEngine getEngine() const;
+
+    // Routes the row to the RowStore (loading it first) or the LSM store
+    bool insert(const Row& row);
+
+    // LSM key column, else the Bloom filter column, else column 0
+    size_t getKeyColumn() const;
+
+    // nullptr unless the table uses the LSM engine
+    LsmStore* getLsmStore();
     
     const Schema& getSchema() const;
+
+    const TableMetadata& getMetadata() const;
+
+    // Served from the file header until the table is loaded. LSM tables merge
+    // every run to count, reading them without keeping any rows.
+    size_t rowCount() const;
+
+    // Rows with low <= row[column] <= high. Before load() only the pages whose
+    // zone map overlaps the range are read from disk.
+    TableData selectRange(size_t column, const Value& low, const Value& high);
+
+    // Like selectRange, pages are pruned by zone map (and Bloom filter for
+    // equality on the key column) until the table is loaded. Once loaded,
+    // only const RowStore access is used, so concurrent calls are safe.
+    TableData select(const Query& query);
+
+    // Answered from a materialized view over the same conditions and
+    // aggregates when one exists, else from the result cache or a scan
+    AggregateResults aggregate(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates);
+
+    // Materializes the aggregate, loading the table first; every RowStore
+    // mutation then updates it in place. Not available for LSM tables.
+    std::optional<size_t> createView(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates);
+
+    bool dropView(size_t id);
+
+    std::optional<AggregateResults> viewResults(size_t id) const;
+
+    // select() and aggregate() results are reused until the next change to
+    // the table; 0 disables the cache
+    void setResultCacheSize(size_t entries);
+
+    ResultCacheStats getResultCacheStats() const;
+
+    // Builds Bloom filters over `column` (per page and per table) on the next flush
+    bool enableBloomFilter(size_t column, uint32_t bitsPerKey = DEFAULT_BLOOM_BITS_PER_KEY);
+
+    // False means no row has this key; true may be a false positive
+    bool mayContain(const Value& key);
+
+    // Rows whose Bloom key column equals key. A filter miss returns without
+    // reading data pages; otherwise only pages whose filter matches are read.
+    TableData findByKey(const Value& key);
+
+    const BloomStats& getBloomStats() const;
+
+    void printStats() const;
+
+    // ORDER BY ... LIMIT limit; limit == 0 returns every row. Before load()
+    // and for LSM tables the rows are read a page at a time into a sort
+    // bounded by the memory budget.
+    TableData orderBy(const OrderBy& keys, size_t limit = 0);
+
+    // Same order, streamed to emit without building the result
+    bool orderBy(const OrderBy& keys, size_t limit, const RowSink& emit);
+
+    void setSortMemoryBudget(size_t bytes);
 };
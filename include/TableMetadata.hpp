@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BloomFilter.hpp"
+#include "FreeSpaceMap.hpp"
+#include "Schema.hpp"
+
+constexpr uint32_t FILE_MAGIC = 0x42444E4D; // "MNDB"
+
+// Version 1 files carry only a bare page count in the header. Versions 1 and 2
+// start data pages after a PAGE_SIZE + 4 byte header and prefix each with its
+// 8-byte used size. Version 3 puts the header in page 0 and page n at
+// n * PAGE_SIZE with no prefix; used sizes live in the page directory.
+constexpr uint32_t LEGACY_FORMAT_VERSION = 1;
+constexpr uint32_t PREFIXED_FORMAT_VERSION = 2;
+constexpr uint32_t FORMAT_VERSION = 3;
+
+struct ColumnStats {
+    bool hasValue = false;
+    Value min;
+    Value max;
+};
+
+// Page directory entry; `stats` is a per-column min/max zone map
+struct PageInfo {
+    uint32_t rowCount = 0;
+    uint32_t usedBytes = 0;
+    std::vector<ColumnStats> stats;
+};
+
+// SCHEMA_OVERFLOW holds the schema and column stats when they do not fit in page 0
+enum RootKind : uint32_t {PAGE_DIRECTORY = 1, FREE_SPACE_MAP = 2, BLOOM_FILTER = 3, SCHEMA_OVERFLOW = 4};
+
+// Auxiliary structure stored in its own pages after the data pages
+struct RootEntry {
+    uint32_t kind;
+    uint32_t firstPage;
+    uint32_t pageCount;
+    uint64_t byteLength;
+};
+
+struct TableMetadata {
+    uint32_t version = FORMAT_VERSION;
+    Schema schema;
+    uint64_t rowCount = 0;
+    uint32_t pageCount = 0;
+    std::vector<ColumnStats> stats;
+    std::vector<PageInfo> pages;
+    FreeSpaceMap freeSpace;
+    BloomIndex bloom;
+    std::vector<RootEntry> roots;
+};
+
+void updateColumnStats(ColumnStats& stats, const Value& value);
+
+void mergeColumnStats(ColumnStats& into, const ColumnStats& from);
+
+// True when [low, high] may contain a value of the column described by stats
+bool statsOverlap(const ColumnStats& stats, const Value& low, const Value& high);
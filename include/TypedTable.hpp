@@ -0,0 +1,292 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "FileManager.hpp"
+#include "Page.hpp"
+#include "Schema.hpp"
+#include "TableMetadata.hpp"
+
+// Per-type encoding, byte-for-byte identical to FileManager::serializeRow so
+// typed and dynamic tables can read each other's files.
+template <typename T>
+struct ColumnTraits;
+
+template <>
+struct ColumnTraits<int> {
+    static constexpr SupportedTypes type = INT;
+    static constexpr size_t fixedSize = sizeof(int);
+
+    static bool write(const int& value, char* buffer, size_t bufferSize, size_t& offset) {
+        if (offset + sizeof(int) > bufferSize) return false;
+        std::memcpy(buffer + offset, &value, sizeof(int));
+        offset += sizeof(int);
+        return true;
+    }
+
+    static bool read(int& value, const char* buffer, size_t bufferSize, size_t& offset) {
+        if (offset + sizeof(int) > bufferSize) return false;
+        std::memcpy(&value, buffer + offset, sizeof(int));
+        offset += sizeof(int);
+        return true;
+    }
+};
+
+template <>
+struct ColumnTraits<double> {
+    static constexpr SupportedTypes type = DOUBLE;
+    static constexpr size_t fixedSize = sizeof(double);
+
+    static bool write(const double& value, char* buffer, size_t bufferSize, size_t& offset) {
+        if (offset + sizeof(double) > bufferSize) return false;
+        std::memcpy(buffer + offset, &value, sizeof(double));
+        offset += sizeof(double);
+        return true;
+    }
+
+    static bool read(double& value, const char* buffer, size_t bufferSize, size_t& offset) {
+        if (offset + sizeof(double) > bufferSize) return false;
+        std::memcpy(&value, buffer + offset, sizeof(double));
+        offset += sizeof(double);
+        return true;
+    }
+};
+
+template <>
+struct ColumnTraits<std::string> {
+    static constexpr SupportedTypes type = STRING;
+    static constexpr size_t fixedSize = 0;
+
+    static bool write(const std::string& value, char* buffer, size_t bufferSize, size_t& offset) {
+        uint32_t len = value.size();
+        if (len > PAGE_SIZE || offset + sizeof(uint32_t) + len > bufferSize) return false;
+        std::memcpy(buffer + offset, &len, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        std::memcpy(buffer + offset, value.data(), len);
+        offset += len;
+        return true;
+    }
+
+    static bool read(std::string& value, const char* buffer, size_t bufferSize, size_t& offset) {
+        if (offset + sizeof(uint32_t) > bufferSize) return false;
+        uint32_t len;
+        std::memcpy(&len, buffer + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        if (len > PAGE_SIZE || offset + len > bufferSize) return false;
+        value.assign(buffer + offset, len);
+        offset += len;
+        return true;
+    }
+};
+
+// Table whose schema is fixed at compile time, e.g. TypedTable<int, std::string, double>.
+// Rows are std::tuple values, so there is no per-field variant check and the
+// (de)serializers are unrolled per column by the compiler.
+template <typename... Columns>
+class TypedTable {
+    public:
+        using RowType = std::tuple<Columns...>;
+
+        static constexpr size_t columnCount = sizeof...(Columns);
+        static constexpr std::array<SupportedTypes, columnCount> columnTypes = {ColumnTraits<Columns>::type...};
+        static constexpr bool fixedWidth = ((ColumnTraits<Columns>::fixedSize > 0) && ...);
+        static constexpr size_t fixedRowSize = (ColumnTraits<Columns>::fixedSize + ... + 0);
+
+    private:
+        std::string filename;
+        std::fstream file;
+        std::array<std::string, columnCount> columnNames;
+        std::vector<RowType> rows;
+        FileManager fileManager;
+        TableMetadata metadata;
+
+        template <size_t... I>
+        static size_t serializeImpl(const RowType& row, char* buffer, size_t bufferSize, std::index_sequence<I...>) {
+            size_t offset = 0;
+            bool ok = (ColumnTraits<std::tuple_element_t<I, RowType>>::write(std::get<I>(row), buffer, bufferSize, offset) && ...);
+            return ok ? offset : 0;
+        }
+
+        template <size_t... I>
+        static size_t deserializeImpl(const char* buffer, size_t bufferSize, RowType& row, std::index_sequence<I...>) {
+            size_t offset = 0;
+            bool ok = (ColumnTraits<std::tuple_element_t<I, RowType>>::read(std::get<I>(row), buffer, bufferSize, offset) && ...);
+            return ok ? offset : 0;
+        }
+
+        template <size_t... I>
+        static Row toRowImpl(const RowType& row, std::index_sequence<I...>) {
+            return Row{std::get<I>(row)...};
+        }
+
+        template <size_t... I>
+        static bool fromRowImpl(const Row& row, RowType& out, std::index_sequence<I...>) {
+            bool ok = (std::holds_alternative<std::tuple_element_t<I, RowType>>(row[I]) && ...);
+            if (ok) {
+                out = RowType{std::get<std::tuple_element_t<I, RowType>>(row[I])...};
+            }
+            return ok;
+        }
+
+    public:
+        TypedTable(const std::string& name, std::ios::openmode mode, const std::array<std::string, columnCount>& columnNames)
+            : filename(name), file(name, mode), columnNames(columnNames), fileManager(name) {}
+
+        ~TypedTable() {
+            if (file.is_open()) {
+                file.close();
+            }
+        }
+
+        static size_t serializeRow(const RowType& row, char* buffer, size_t bufferSize) {
+            if (buffer == nullptr || bufferSize == 0) return 0;
+            return serializeImpl(row, buffer, bufferSize, std::index_sequence_for<Columns...>{});
+        }
+
+        static size_t deserializeRow(const char* buffer, size_t bufferSize, RowType& row) {
+            if (buffer == nullptr || bufferSize == 0) return 0;
+            return deserializeImpl(buffer, bufferSize, row, std::index_sequence_for<Columns...>{});
+        }
+
+        static Row toRow(const RowType& row) {
+            return toRowImpl(row, std::index_sequence_for<Columns...>{});
+        }
+
+        static bool fromRow(const Row& row, RowType& out) {
+            if (row.size() != columnCount) return false;
+            return fromRowImpl(row, out, std::index_sequence_for<Columns...>{});
+        }
+
+        Schema getSchema() const {
+            Schema schema;
+            for (size_t i = 0; i < columnCount; i++) {
+                schema.push_back({columnNames[i], columnTypes[i]});
+            }
+            return schema;
+        }
+
+        // Returns false, loading nothing, if the file's column types differ from
+        // the compiled ones; decoding such pages would yield garbage rows.
+        bool load() {
+            rows.clear();
+            if (!fileManager.readMetadata(file, metadata)) {
+                return true;
+            }
+
+            if (!metadata.schema.empty()) {
+                bool typesMatch = metadata.schema.size() == columnCount;
+                for (size_t i = 0; typesMatch && i < columnCount; i++) {
+                    typesMatch = metadata.schema[i].second == columnTypes[i];
+                }
+                if (!typesMatch) {
+                    std::cerr << "Warning: Column types of " << filename << " differ from the table type, not loaded\n";
+                    return false;
+                }
+                if (metadata.schema != getSchema()) {
+                    std::cerr << "Warning: Schema of " << filename << " differs from the file header\n";
+                }
+            }
+
+            fileManager.readDataRows(file, metadata, [this](const char* buffer, size_t bufferSize, uint32_t) {
+                RowType row;
+                size_t bytesRead = deserializeRow(buffer, bufferSize, row);
+                if (bytesRead > 0) {
+                    rows.push_back(std::move(row));
+                }
+                return bytesRead;
+            });
+            return true;
+        }
+
+        void flush() {
+            fileManager.writeRows(file, getSchema(), rows.size(), [this](size_t i, char* buffer, size_t bufferSize) {
+                return serializeRow(rows[i], buffer, bufferSize);
+            }, metadata);
+        }
+
+        const TableMetadata& getMetadata() const { return metadata; }
+
+        std::vector<RowType>& getData() { return rows; }
+        const std::vector<RowType>& getData() const { return rows; }
+
+        void clear() { rows.clear(); }
+
+        size_t rowCount() const { return rows.size(); }
+
+        void insert(const RowType& row) {
+            rows.push_back(row);
+        }
+
+        void insert(RowType&& row) {
+            rows.push_back(std::move(row));
+        }
+
+        std::optional<RowType> getRow(size_t index) const {
+            if (index >= rows.size()) {
+                return std::nullopt;
+            }
+            return rows[index];
+        }
+
+        template <typename Predicate>
+        std::vector<RowType> select(Predicate&& predicate) const {
+            std::vector<RowType> result;
+            for (const auto& row : rows) {
+                if (predicate(row)) {
+                    result.push_back(row);
+                }
+            }
+            return result;
+        }
+
+        // Predicate receives only the value of column `Column`, e.g.
+        // selectWhere<2>([](double salary) { return salary > 80000.0; })
+        template <size_t Column, typename Predicate>
+        std::vector<RowType> selectWhere(Predicate&& predicate) const {
+            static_assert(Column < columnCount, "column index out of range");
+            return select([&](const RowType& row) { return predicate(std::get<Column>(row)); });
+        }
+
+        bool update(size_t index, const RowType& newRow) {
+            if (index >= rows.size()) {
+                return false;
+            }
+            rows[index] = newRow;
+            return true;
+        }
+
+        template <typename Predicate, typename UpdateFunc>
+        size_t updateWhere(Predicate&& predicate, UpdateFunc&& updateFunc) {
+            size_t updateCount = 0;
+            for (auto& row : rows) {
+                if (predicate(row)) {
+                    row = updateFunc(row);
+                    updateCount++;
+                }
+            }
+            return updateCount;
+        }
+
+        bool deleteRow(size_t index) {
+            if (index >= rows.size()) {
+                return false;
+            }
+            rows.erase(rows.begin() + index);
+            return true;
+        }
+
+        template <typename Predicate>
+        size_t deleteWhere(Predicate&& predicate) {
+            size_t initialSize = rows.size();
+            rows.erase(std::remove_if(rows.begin(), rows.end(), predicate), rows.end());
+            return initialSize - rows.size();
+        }
+};
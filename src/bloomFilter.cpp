@@ -0,0 +1,153 @@
+#include "BloomFilter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Odd multipliers giving each lane an independent bit position
+constexpr uint32_t SALTS[8] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+};
+
+uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+}
+
+uint64_t hashFieldBytes(const char* data, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 0x100000001b3ull;
+    }
+    return mix64(h);
+}
+
+uint64_t hashDouble(double value) {
+    if (value == 0.0) {
+        value = 0.0;
+    }
+    return hashFieldBytes(reinterpret_cast<const char*>(&value), sizeof(double));
+}
+
+uint64_t hashValue(const Value& value) {
+    if (const int* v = std::get_if<int>(&value)) {
+        return hashFieldBytes(reinterpret_cast<const char*>(v), sizeof(int));
+    }
+    if (const double* v = std::get_if<double>(&value)) {
+        return hashDouble(*v);
+    }
+
+    const std::string& s = std::get<std::string>(value);
+    std::string encoded(sizeof(uint32_t) + s.size(), '\0');
+    uint32_t len = s.size();
+    std::memcpy(encoded.data(), &len, sizeof(uint32_t));
+    std::memcpy(encoded.data() + sizeof(uint32_t), s.data(), s.size());
+    return hashFieldBytes(encoded.data(), encoded.size());
+}
+
+BloomFilter::BloomFilter(size_t expectedKeys, uint32_t bitsPerKey) {
+    size_t bits = std::max<size_t>(expectedKeys, 1) * std::max<uint32_t>(bitsPerKey, 1);
+    blocks.assign((bits + BLOCK_BITS - 1) / BLOCK_BITS, Block{});
+}
+
+size_t BloomFilter::blockIndex(uint64_t hash) const {
+    // Multiply-shift maps the upper half onto [0, blocks) without a division
+    return ((hash >> 32) * blocks.size()) >> 32;
+}
+
+void BloomFilter::insert(uint64_t hash) {
+    if (blocks.empty()) return;
+
+    Block& block = blocks[blockIndex(hash)];
+    uint32_t key = static_cast<uint32_t>(hash);
+
+    for (int lane = 0; lane < 8; lane++) {
+        block.words[lane] |= 1ull << ((key * SALTS[lane]) >> 26);
+    }
+    keyCount++;
+}
+
+bool BloomFilter::mayContain(uint64_t hash) const {
+    if (blocks.empty()) return false;
+
+    const Block& block = blocks[blockIndex(hash)];
+    uint32_t key = static_cast<uint32_t>(hash);
+    uint64_t missing = 0;
+
+    for (int lane = 0; lane < 8; lane++) {
+        missing |= ~block.words[lane] & (1ull << ((key * SALTS[lane]) >> 26));
+    }
+
+    return missing == 0;
+}
+
+bool BloomFilter::empty() const {
+    return blocks.empty();
+}
+
+uint64_t BloomFilter::size() const {
+    return keyCount;
+}
+
+size_t BloomFilter::sizeInBytes() const {
+    return blocks.size() * sizeof(Block);
+}
+
+// Keys land in blocks as a Poisson process with mean n / blocks; a block with
+// i keys answers a foreign probe positively with (1 - (63/64)^i)^8.
+double BloomFilter::expectedFalsePositiveRate() const {
+    if (blocks.empty()) return 0.0;
+
+    double lambda = static_cast<double>(keyCount) / blocks.size();
+    double term = std::exp(-lambda);
+    double rate = 0.0;
+    size_t limit = static_cast<size_t>(lambda + 10 * std::sqrt(lambda) + 10);
+
+    for (size_t i = 0; i <= limit; i++) {
+        if (i > 0) term *= lambda / i;
+        rate += term * std::pow(1.0 - std::pow(63.0 / 64.0, static_cast<double>(i)), 8);
+    }
+
+    return rate;
+}
+
+void BloomFilter::serialize(std::vector<char>& out) const {
+    uint32_t blockCount = blocks.size();
+    const char* header = reinterpret_cast<const char*>(&blockCount);
+    out.insert(out.end(), header, header + sizeof(blockCount));
+    const char* count = reinterpret_cast<const char*>(&keyCount);
+    out.insert(out.end(), count, count + sizeof(keyCount));
+
+    for (const auto& block : blocks) {
+        const char* bytes = reinterpret_cast<const char*>(block.words);
+        out.insert(out.end(), bytes, bytes + sizeof(block.words));
+    }
+}
+
+bool BloomFilter::deserialize(const char* data, size_t size, size_t& offset) {
+    uint32_t blockCount = 0;
+    if (offset + sizeof(blockCount) + sizeof(keyCount) > size) return false;
+    std::memcpy(&blockCount, data + offset, sizeof(blockCount));
+    offset += sizeof(blockCount);
+    std::memcpy(&keyCount, data + offset, sizeof(keyCount));
+    offset += sizeof(keyCount);
+
+    if (offset + static_cast<size_t>(blockCount) * sizeof(Block::words) > size) return false;
+
+    blocks.assign(blockCount, Block{});
+    for (auto& block : blocks) {
+        std::memcpy(block.words, data + offset, sizeof(block.words));
+        offset += sizeof(block.words);
+    }
+
+    return true;
+}
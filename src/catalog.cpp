@@ -0,0 +1,239 @@
+#include "Catalog.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+template <typename T>
+void writeValue(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(std::ofstream& out, const std::string& s) {
+    writeValue(out, static_cast<uint32_t>(s.size()));
+    out.write(s.data(), s.size());
+}
+
+template <typename T>
+bool readValue(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool readString(std::ifstream& in, std::string& s) {
+    uint32_t len = 0;
+    if (!readValue(in, len)) return false;
+    s.resize(len);
+    return static_cast<bool>(in.read(s.data(), len));
+}
+
+}
+
+Catalog::Catalog(const std::string& path) : path(path) {
+    loadEntries();
+}
+
+bool Catalog::loadEntries() {
+    entries.clear();
+
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    uint32_t magic = 0, version = 0, count = 0;
+    if (!readValue(in, magic) || magic != CATALOG_MAGIC ||
+        !readValue(in, version) || version > CATALOG_VERSION ||
+        !readValue(in, count)) {
+        std::cerr << "Warning: " << path << " is not a catalog file\n";
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        CatalogEntry entry;
+        uint32_t columnCount = 0;
+        if (!readString(in, entry.name) || !readString(in, entry.filename) || !readValue(in, columnCount)) {
+            return false;
+        }
+
+        for (uint32_t col = 0; col < columnCount; col++) {
+            std::string name;
+            uint8_t type = 0;
+            if (!readString(in, name) || !readValue(in, type) || type > STRING) {
+                return false;
+            }
+            entry.schema.push_back({name, static_cast<SupportedTypes>(type)});
+        }
+
+        // Version 1 catalogs only held row-store tables
+        uint8_t engine = ROW_STORE;
+        if (version >= 2 && (!readValue(in, engine) || engine > LSM)) {
+            return false;
+        }
+        entry.engine = static_cast<StorageEngine>(engine);
+
+        if (entry.engine == LSM) {
+            LsmOptions& options = entry.lsmOptions;
+            uint32_t keyColumn = 0, runsPerLevel = 0;
+            uint64_t memtableBytes = 0;
+            uint8_t background = 0;
+            if (!readValue(in, keyColumn) || !readValue(in, memtableBytes) || !readValue(in, runsPerLevel) ||
+                !readValue(in, options.bitsPerKey) || !readValue(in, background)) {
+                return false;
+            }
+            options.keyColumn = keyColumn;
+            options.memtableBytes = memtableBytes;
+            options.runsPerLevel = runsPerLevel;
+            options.backgroundCompaction = background != 0;
+        }
+
+        entries.push_back(std::move(entry));
+    }
+
+    return true;
+}
+
+bool Catalog::save() const {
+    // Written aside and renamed over the old file, so a failed save keeps it
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        writeValue(out, CATALOG_MAGIC);
+        writeValue(out, CATALOG_VERSION);
+        writeValue(out, static_cast<uint32_t>(entries.size()));
+
+        for (const auto& entry : entries) {
+            writeString(out, entry.name);
+            writeString(out, entry.filename);
+            writeValue(out, static_cast<uint32_t>(entry.schema.size()));
+            for (const auto& col : entry.schema) {
+                writeString(out, col.first);
+                writeValue(out, static_cast<uint8_t>(col.second));
+            }
+
+            writeValue(out, static_cast<uint8_t>(entry.engine));
+            if (entry.engine == LSM) {
+                const LsmOptions& options = entry.lsmOptions;
+                writeValue(out, static_cast<uint32_t>(options.keyColumn));
+                writeValue(out, static_cast<uint64_t>(options.memtableBytes));
+                writeValue(out, static_cast<uint32_t>(options.runsPerLevel));
+                writeValue(out, options.bitsPerKey);
+                writeValue(out, static_cast<uint8_t>(options.backgroundCompaction));
+            }
+        }
+
+        if (!out.good()) {
+            return false;
+        }
+    }
+
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+bool Catalog::createTable(const std::string& name, const std::string& filename, const Schema& schema) {
+    return addEntry({name, filename, schema, ROW_STORE, LsmOptions()});
+}
+
+bool Catalog::createTable(const std::string& name, const std::string& filename, const Schema& schema,
+                          const LsmOptions& options) {
+    if (options.keyColumn >= schema.size()) {
+        std::cerr << "Warning: LSM key column out of range, table " << name << " not created\n";
+        return false;
+    }
+    return addEntry({name, filename, schema, LSM, options});
+}
+
+bool Catalog::addEntry(const CatalogEntry& entry) {
+    const std::string& name = entry.name;
+    const std::string& filename = entry.filename;
+    if (find(name).has_value()) {
+        return false;
+    }
+
+    // Creating truncates the file, so never point at another table's file or
+    // at data the catalog does not know about (e.g. a dropped table's file)
+    std::error_code ec;
+    auto target = std::filesystem::weakly_canonical(filename, ec);
+    for (const auto& other : entries) {
+        if (!ec && std::filesystem::weakly_canonical(other.filename, ec) == target) {
+            std::cerr << "Warning: " << filename << " already belongs to table " << other.name << "\n";
+            return false;
+        }
+    }
+    if (ec || std::filesystem::exists(filename, ec)) {
+        std::cerr << "Warning: " << filename << " already exists, table " << name << " not created\n";
+        return false;
+    }
+
+    // Write an empty table so the file header (or LSM manifest) exists from the start
+    {
+        auto mode = std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc;
+        if (entry.engine == LSM) {
+            Table table(filename, mode, entry.schema, entry.lsmOptions);
+        } else {
+            Table table(filename, mode, entry.schema);
+            table.flush();
+        }
+    }
+
+    entries.push_back(entry);
+    if (!save()) {
+        entries.pop_back();
+        return false;
+    }
+
+    return true;
+}
+
+bool Catalog::dropTable(const std::string& name) {
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->name == name) {
+            CatalogEntry removed = *it;
+            entries.erase(it);
+            if (!save()) {
+                entries.push_back(removed);
+                return false;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::optional<CatalogEntry> Catalog::find(const std::string& name) const {
+    for (const auto& entry : entries) {
+        if (entry.name == name) {
+            return entry;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::vector<std::string> Catalog::tableNames() const {
+    std::vector<std::string> names;
+    for (const auto& entry : entries) {
+        names.push_back(entry.name);
+    }
+    return names;
+}
+
+std::unique_ptr<Table> Catalog::openTable(const std::string& name) {
+    auto entry = find(name);
+    if (!entry.has_value()) {
+        return nullptr;
+    }
+
+    auto mode = std::ios::in | std::ios::out | std::ios::binary;
+    if (entry->engine == LSM) {
+        return std::make_unique<Table>(entry->filename, mode, entry->schema, entry->lsmOptions);
+    }
+
+    return std::make_unique<Table>(entry->filename, mode, entry->schema);
+}
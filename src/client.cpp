@@ -0,0 +1,220 @@
+#include "Client.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+Client::~Client() {
+    disconnect();
+}
+
+bool Client::connectUnix(const std::string& path) {
+    disconnect();
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "Warning: Cannot connect to " << path << ": " << std::strerror(errno) << "\n";
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+bool Client::connectTcp(const std::string& host, uint16_t port) {
+    disconnect();
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        return false;
+    }
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "Warning: Cannot connect to " << host << ":" << port << ": " << std::strerror(errno) << "\n";
+        disconnect();
+        return false;
+    }
+
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return true;
+}
+
+void Client::disconnect() {
+    if (fd >= 0) {
+        close(fd);
+    }
+    fd = -1;
+    output.clear();
+    input.clear();
+    inputOffset = 0;
+    pending.clear();
+}
+
+uint32_t Client::enqueue(Request request) {
+    request.id = nextId++;
+    if (nextId == 0) nextId = 1;
+
+    if (!encodeRequest(request, output)) {
+        return 0;
+    }
+    pending.push_back(request.op);
+    return request.id;
+}
+
+bool Client::send() {
+    size_t offset = 0;
+    while (offset < output.size()) {
+        ssize_t n = ::send(fd, output.data() + offset, output.size() - offset, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            output.clear();
+            return false;
+        }
+        offset += n;
+    }
+    output.clear();
+    return true;
+}
+
+bool Client::readFrame(size_t& frameSize) {
+    while (true) {
+        FrameState state = nextFrame(input.data() + inputOffset, input.size() - inputOffset, frameSize);
+        if (state == FRAME_READY) return true;
+        if (state == FRAME_INVALID) return false;
+
+        if (inputOffset > 0) {
+            input.erase(input.begin(), input.begin() + inputOffset);
+            inputOffset = 0;
+        }
+
+        size_t used = input.size();
+        input.resize(used + 64 * 1024);
+        ssize_t n = recv(fd, input.data() + used, input.size() - used, 0);
+        input.resize(used + (n > 0 ? n : 0));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+    }
+}
+
+bool Client::receive(Response& response) {
+    if (pending.empty() || fd < 0) {
+        return false;
+    }
+
+    size_t frameSize = 0;
+    if (!readFrame(frameSize)) {
+        return false;
+    }
+
+    Opcode op = pending.front();
+    pending.pop_front();
+
+    bool ok = decodeResponse(input.data() + inputOffset, frameSize, op, response);
+    inputOffset += frameSize;
+    return ok;
+}
+
+size_t Client::pendingCount() const {
+    return pending.size();
+}
+
+std::optional<Response> Client::call(Request request) {
+    if (!pending.empty() || enqueue(std::move(request)) == 0 || !send()) {
+        return std::nullopt;
+    }
+
+    Response response;
+    if (!receive(response)) {
+        return std::nullopt;
+    }
+    if (response.status != STATUS_OK) {
+        std::cerr << "Warning: Server error: " << response.error << "\n";
+        return std::nullopt;
+    }
+    return response;
+}
+
+bool Client::ping() {
+    return call(Request()).has_value();
+}
+
+std::optional<Schema> Client::schema(const std::string& table) {
+    Request request;
+    request.op = OP_SCHEMA;
+    request.table = table;
+
+    auto response = call(std::move(request));
+    if (!response) return std::nullopt;
+    return response->schema;
+}
+
+std::optional<uint64_t> Client::insert(const std::string& table, const TableData& rows) {
+    Request request;
+    request.op = OP_INSERT;
+    request.table = table;
+    request.rows = rows;
+
+    auto response = call(std::move(request));
+    if (!response) return std::nullopt;
+    return response->count;
+}
+
+std::optional<TableData> Client::get(const std::string& table, const Value& key) {
+    Request request;
+    request.op = OP_GET;
+    request.table = table;
+    request.key = key;
+
+    auto response = call(std::move(request));
+    if (!response) return std::nullopt;
+    return std::move(response->rows);
+}
+
+std::optional<TableData> Client::select(const std::string& table, const Query& query) {
+    Request request;
+    request.op = OP_SELECT;
+    request.table = table;
+    request.query = query;
+
+    auto response = call(std::move(request));
+    if (!response) return std::nullopt;
+    return std::move(response->rows);
+}
+
+std::optional<AggregateResults> Client::aggregate(
+    const std::string& table,
+    const std::vector<Condition>& where,
+    const std::vector<Aggregate>& aggregates)
+{
+    Request request;
+    request.op = OP_AGGREGATE;
+    request.table = table;
+    request.query.where = where;
+    request.aggregates = aggregates;
+
+    auto response = call(std::move(request));
+    if (!response) return std::nullopt;
+    return std::move(response->values);
+}
+
+bool Client::flush(const std::string& table) {
+    Request request;
+    request.op = OP_FLUSH;
+    request.table = table;
+    return call(std::move(request)).has_value();
+}
@@ -1,10 +1,141 @@
 #include "FileManager.hpp"
+#include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <string_view>
+#include <thread>
+#include <atomic>
 
+// Versions 1 and 2 only
 constexpr size_t HEADER_SIZE = sizeof(uint32_t);
 constexpr size_t DATA_PAGE_OFFSET = PAGE_SIZE + HEADER_SIZE;
 
+namespace {
+
+template <typename T>
+void putValue(std::vector<char>& out, const T& value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void putString(std::vector<char>& out, const std::string& s) {
+    putValue(out, static_cast<uint32_t>(s.size()));
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+void putField(std::vector<char>& out, SupportedTypes type, const Value& value) {
+    switch (type) {
+        case INT: putValue(out, std::get<int>(value)); break;
+        case DOUBLE: putValue(out, std::get<double>(value)); break;
+        case STRING: putString(out, std::get<std::string>(value)); break;
+    }
+}
+
+void putStats(std::vector<char>& out, SupportedTypes type, const ColumnStats& stats) {
+    putValue(out, static_cast<uint8_t>(stats.hasValue));
+    if (stats.hasValue) {
+        putField(out, type, stats.min);
+        putField(out, type, stats.max);
+    }
+}
+
+struct ByteReader {
+    const char* data;
+    size_t size;
+    size_t offset = 0;
+
+    template <typename T>
+    bool get(T& value) {
+        if (offset + sizeof(T) > size) return false;
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& s) {
+        uint32_t len = 0;
+        if (!get(len) || offset + len > size) return false;
+        s.assign(data + offset, len);
+        offset += len;
+        return true;
+    }
+
+    bool getField(SupportedTypes type, Value& value) {
+        switch (type) {
+            case INT: { int v; if (!get(v)) return false; value = v; return true; }
+            case DOUBLE: { double v; if (!get(v)) return false; value = v; return true; }
+            case STRING: { std::string v; if (!getString(v)) return false; value = std::move(v); return true; }
+        }
+        return false;
+    }
+
+    bool getStats(SupportedTypes type, ColumnStats& stats) {
+        uint8_t hasValue = 0;
+        if (!get(hasValue)) return false;
+        stats.hasValue = hasValue != 0;
+        return !stats.hasValue || (getField(type, stats.min) && getField(type, stats.max));
+    }
+};
+
+void encodeSchema(std::vector<char>& out, const TableMetadata& metadata, bool withStats) {
+    putValue(out, static_cast<uint32_t>(metadata.schema.size()));
+    for (const auto& col : metadata.schema) {
+        putString(out, col.first);
+        putValue(out, static_cast<uint8_t>(col.second));
+    }
+    
+    for (size_t i = 0; i < metadata.schema.size(); i++) {
+        bool keep = withStats && i < metadata.stats.size();
+        putStats(out, metadata.schema[i].second, keep ? metadata.stats[i] : ColumnStats());
+    }
+}
+
+bool decodeSchema(ByteReader& reader, TableMetadata& metadata) {
+    uint32_t columnCount = 0;
+    bool ok = reader.get(columnCount);
+    
+    metadata.schema.clear();
+    for (uint32_t i = 0; ok && i < columnCount; i++) {
+        std::string name;
+        uint8_t type = 0;
+        ok = reader.getString(name) && reader.get(type) && type <= STRING;
+        metadata.schema.push_back({name, static_cast<SupportedTypes>(type)});
+    }
+    
+    metadata.stats.assign(metadata.schema.size(), ColumnStats());
+    for (uint32_t i = 0; ok && i < columnCount; i++) {
+        ok = reader.getStats(metadata.schema[i].second, metadata.stats[i]);
+    }
+    
+    return ok;
+}
+
+// Without the schema the column count is written as 0 and the schema goes to
+// a SCHEMA_OVERFLOW root
+void encodeHeader(std::vector<char>& out, const TableMetadata& metadata, bool withStats, bool withSchema) {
+    out.clear();
+    putValue(out, FILE_MAGIC);
+    putValue(out, metadata.version);
+    putValue(out, metadata.pageCount);
+    putValue(out, metadata.rowCount);
+    
+    if (withSchema) {
+        encodeSchema(out, metadata, withStats);
+    } else {
+        putValue(out, static_cast<uint32_t>(0));
+    }
+    
+    putValue(out, static_cast<uint32_t>(metadata.roots.size()));
+    for (const auto& root : metadata.roots) {
+        putValue(out, root.kind);
+        putValue(out, root.firstPage);
+        putValue(out, root.pageCount);
+        putValue(out, root.byteLength);
+    }
+}
+
+}
+
 size_t FileManager::serializeRow(
     const Row& row,
     char* buffer,
@@ -97,38 +228,213 @@ size_t FileManager::deserializeRow(
     return offset;
 }
 
-void FileManager::writeHeader(std::fstream& file, uint32_t pageCount) {
+FileManager::FileManager(const std::string& path) : path(path) {}
+
+void FileManager::writeHeader(std::fstream& file, const TableMetadata& metadata) {
+    bool withSchema = std::none_of(metadata.roots.begin(), metadata.roots.end(), [](const RootEntry& root) {
+        return root.kind == SCHEMA_OVERFLOW;
+    });
+    
+    std::vector<char> buffer;
+    encodeHeader(buffer, metadata, true, withSchema);
+    
+    if (buffer.size() > PAGE_SIZE) {
+        encodeHeader(buffer, metadata, false, withSchema);
+    }
+    
     file.seekp(0, std::ios::beg);
-    file.write(reinterpret_cast<const char*>(&pageCount), sizeof(pageCount));
+    file.write(buffer.data(), buffer.size());
     file.flush();
 }
 
-uint32_t FileManager::readHeader(std::fstream& file) {
+bool FileManager::readHeader(std::fstream& file, TableMetadata& metadata) {
+    metadata = TableMetadata();
+    
+    std::vector<char> buffer(DATA_PAGE_OFFSET);
     file.seekg(0, std::ios::beg);
-    uint32_t pageCount = 0;
-    file.read(reinterpret_cast<char*>(&pageCount), sizeof(pageCount));
-    if (file.fail()) {
-        file.clear();
-        return 0;
+    file.read(buffer.data(), buffer.size());
+    size_t bytesRead = file.gcount();
+    file.clear();
+    
+    ByteReader reader{buffer.data(), bytesRead};
+    uint32_t magic = 0;
+    if (!reader.get(magic)) {
+        return false;
     }
-    return pageCount;
+    
+    if (magic != FILE_MAGIC) {
+        // Legacy layout: the first word is the page count
+        metadata.version = LEGACY_FORMAT_VERSION;
+        metadata.pageCount = magic;
+        return true;
+    }
+    
+    bool ok = reader.get(metadata.version) &&
+              reader.get(metadata.pageCount) &&
+              reader.get(metadata.rowCount);
+    
+    if (!ok || metadata.version > FORMAT_VERSION) {
+        return false;
+    }
+    
+    ok = decodeSchema(reader, metadata);
+    
+    uint32_t rootCount = 0;
+    ok = ok && reader.get(rootCount);
+    for (uint32_t i = 0; ok && i < rootCount; i++) {
+        RootEntry root;
+        ok = reader.get(root.kind) &&
+             reader.get(root.firstPage) &&
+             reader.get(root.pageCount) &&
+             reader.get(root.byteLength);
+        metadata.roots.push_back(root);
+    }
+    
+    return ok;
 }
 
-void FileManager::writePage(std::fstream& file, const Page& page, size_t pageNum) {
-    size_t offset = DATA_PAGE_OFFSET + (pageNum - 1) * (PAGE_SIZE + sizeof(size_t));
+RootEntry FileManager::writeBlob(
+    std::fstream& file,
+    uint32_t kind,
+    uint32_t firstPage,
+    const std::vector<char>& blob)
+{
+    RootEntry root{kind, firstPage, 0, blob.size()};
+    Page page;
+    
+    for (size_t offset = 0; offset < blob.size(); offset += PAGE_SIZE) {
+        page.clear();
+        page.used_bytes = std::min(PAGE_SIZE, blob.size() - offset);
+        std::memcpy(page.data.data(), blob.data() + offset, page.used_bytes);
+        writePage(file, page, firstPage + root.pageCount);
+        root.pageCount++;
+    }
+    
+    return root;
+}
+
+bool FileManager::readBlob(std::fstream& file, const RootEntry& root, uint32_t version, std::vector<char>& blob) {
+    blob.clear();
+    blob.reserve(root.byteLength);
+    Page page;
+    
+    for (uint32_t i = 0; i < root.pageCount; i++) {
+        if (!readPage(file, page, root.firstPage + i, version) || page.used_bytes > PAGE_SIZE) {
+            file.clear();
+            return false;
+        }
+        
+        // Bare pages are full except the last
+        size_t used = page.used_bytes;
+        if (version >= FORMAT_VERSION) {
+            used = std::min<uint64_t>(PAGE_SIZE, root.byteLength - std::min<uint64_t>(blob.size(), root.byteLength));
+        }
+        blob.insert(blob.end(), page.data.data(), page.data.data() + used);
+    }
+    
+    return blob.size() == root.byteLength;
+}
+
+void FileManager::writeMetadata(std::fstream& file, TableMetadata& metadata) {
+    metadata.version = FORMAT_VERSION;
+    metadata.pageCount = metadata.pages.size();
+    metadata.rowCount = 0;
+    metadata.stats.assign(metadata.schema.size(), ColumnStats());
+    
+    std::vector<char> directory;
+    for (const auto& page : metadata.pages) {
+        metadata.rowCount += page.rowCount;
+        putValue(directory, page.rowCount);
+        putValue(directory, page.usedBytes);
+        
+        for (size_t col = 0; col < metadata.schema.size(); col++) {
+            mergeColumnStats(metadata.stats[col], page.stats[col]);
+            putStats(directory, metadata.schema[col].second, page.stats[col]);
+        }
+    }
+    
+    metadata.freeSpace.clear();
+    for (uint32_t i = 0; i < metadata.pageCount; i++) {
+        metadata.freeSpace.setFreeBytes(i + 1, PAGE_SIZE - metadata.pages[i].usedBytes);
+    }
+    
+    metadata.roots.clear();
+    RootEntry directoryRoot = writeBlob(file, PAGE_DIRECTORY, metadata.pageCount + 1, directory);
+    metadata.roots.push_back(directoryRoot);
     
-    file.seekp(offset, std::ios::beg);
-    file.write(reinterpret_cast<const char*>(&page.used_bytes), sizeof(page.used_bytes));
+    uint32_t nextPage = directoryRoot.firstPage + directoryRoot.pageCount;
+    RootEntry freeSpaceRoot = writeBlob(file, FREE_SPACE_MAP, nextPage, metadata.freeSpace.serialize());
+    metadata.roots.push_back(freeSpaceRoot);
+    nextPage = freeSpaceRoot.firstPage + freeSpaceRoot.pageCount;
+    
+    if (metadata.bloom.enabled) {
+        std::vector<char> filters;
+        putValue(filters, metadata.bloom.keyColumn);
+        putValue(filters, metadata.bloom.bitsPerKey);
+        metadata.bloom.table.serialize(filters);
+        putValue(filters, static_cast<uint32_t>(metadata.bloom.pages.size()));
+        for (const auto& filter : metadata.bloom.pages) {
+            filter.serialize(filters);
+        }
+        RootEntry bloomRoot = writeBlob(file, BLOOM_FILTER, nextPage, filters);
+        metadata.roots.push_back(bloomRoot);
+        nextPage = bloomRoot.firstPage + bloomRoot.pageCount;
+    }
+    
+    // Page 0 must hold the header; a schema too wide for it moves to its own root
+    std::vector<char> header;
+    encodeHeader(header, metadata, false, true);
+    if (header.size() + sizeof(RootEntry) > PAGE_SIZE) {
+        std::vector<char> schema;
+        encodeSchema(schema, metadata, true);
+        metadata.roots.push_back(writeBlob(file, SCHEMA_OVERFLOW, nextPage, schema));
+    }
+    
+    writeHeader(file, metadata);
+}
+
+uint64_t FileManager::pageOffset(uint32_t version, size_t pageNum) {
+    if (version >= FORMAT_VERSION) {
+        return static_cast<uint64_t>(pageNum) * PAGE_SIZE;
+    }
+    return DATA_PAGE_OFFSET + (pageNum - 1) * (PAGE_SIZE + sizeof(size_t));
+}
+
+void FileManager::writePage(std::fstream& file, const Page& page, size_t pageNum) {
+    file.seekp(pageOffset(FORMAT_VERSION, pageNum), std::ios::beg);
     file.write(page.data.data(), PAGE_SIZE);
 }
 
-bool FileManager::readPage(std::fstream& file, Page& page, size_t pageNum) {
-    size_t offset = DATA_PAGE_OFFSET + (pageNum - 1) * (PAGE_SIZE + sizeof(size_t));
+void FileManager::writeDataPages(std::fstream& file, const std::vector<std::pair<uint32_t, const char*>>& pages) {
+    PageWriter writer(path);
+    
+    if (writer.isOpen()) {
+        // Nothing buffered in the fstream may land after the direct writes
+        file.flush();
+        for (const auto& [pageNum, data] : pages) {
+            writer.add(pageOffset(FORMAT_VERSION, pageNum), data);
+        }
+        if (writer.flush()) {
+            return;
+        }
+        file.clear();
+    }
     
-    file.seekg(offset, std::ios::beg);
+    for (const auto& [pageNum, data] : pages) {
+        file.seekp(pageOffset(FORMAT_VERSION, pageNum), std::ios::beg);
+        file.write(data, PAGE_SIZE);
+    }
+}
+
+bool FileManager::readPage(std::fstream& file, Page& page, size_t pageNum, uint32_t version) {
+    file.seekg(pageOffset(version, pageNum), std::ios::beg);
     
-    file.read(reinterpret_cast<char*>(&page.used_bytes), sizeof(page.used_bytes));
-    if (file.eof() || file.fail()) return false;
+    if (version >= FORMAT_VERSION) {
+        page.used_bytes = PAGE_SIZE;
+    } else {
+        file.read(reinterpret_cast<char*>(&page.used_bytes), sizeof(page.used_bytes));
+        if (file.eof() || file.fail()) return false;
+    }
     
     file.read(page.data.data(), PAGE_SIZE);
     if (file.fail()) return false;
@@ -136,75 +442,638 @@ bool FileManager::readPage(std::fstream& file, Page& page, size_t pageNum) {
     return true;
 }
 
-void FileManager::write(std::fstream& file, const TableData& tableData) {
-    file.seekp(0, std::ios::beg);
+bool FileManager::readDataPage(std::fstream& file, Page& page, size_t pageNum, const TableMetadata& metadata) {
+    if (metadata.version >= FORMAT_VERSION && pageNum > metadata.pages.size()) {
+        return false;
+    }
     
-    Page currentPage;
-    char tempBuffer[PAGE_SIZE];
-    uint32_t pageCount = 0;
+    if (!readPage(file, page, pageNum, metadata.version) || page.used_bytes > PAGE_SIZE) {
+        file.clear();
+        return false;
+    }
     
-    for (const auto& row : tableData) {
-        size_t rowSize = serializeRow(row, tempBuffer, PAGE_SIZE);
+    if (metadata.version >= FORMAT_VERSION) {
+        page.used_bytes = std::min<size_t>(PAGE_SIZE, metadata.pages[pageNum - 1].usedBytes);
+    }
+    return true;
+}
+
+void FileManager::runTasks(size_t taskCount, const std::function<void(size_t)>& task) {
+    size_t threads = std::min<size_t>(taskCount, std::max(1u, std::thread::hardware_concurrency()));
+    
+    if (threads <= 1) {
+        for (size_t i = 0; i < taskCount; i++) {
+            task(i);
+        }
+        return;
+    }
+    
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            for (size_t i = next++; i < taskCount; i = next++) {
+                task(i);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void FileManager::accumulateStats(
+    const Schema& schema,
+    const char* row,
+    size_t rowSize,
+    std::vector<ColumnStats>& stats)
+{
+    size_t offset = 0;
+    
+    for (size_t col = 0; col < schema.size() && offset < rowSize; col++) {
+        switch (schema[col].second) {
+            case INT: {
+                int value;
+                std::memcpy(&value, row + offset, sizeof(int));
+                offset += sizeof(int);
+                updateColumnStats(stats[col], value);
+                break;
+            }
+            case DOUBLE: {
+                double value;
+                std::memcpy(&value, row + offset, sizeof(double));
+                offset += sizeof(double);
+                updateColumnStats(stats[col], value);
+                break;
+            }
+            case STRING: {
+                uint32_t len;
+                std::memcpy(&len, row + offset, sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                std::string_view value(row + offset, len);
+                offset += len;
+                
+                // Compare in place so only new extremes allocate
+                ColumnStats& s = stats[col];
+                if (!s.hasValue) {
+                    s.hasValue = true;
+                    s.min = std::string(value);
+                    s.max = std::string(value);
+                } else if (value < std::get<std::string>(s.min)) {
+                    s.min = std::string(value);
+                } else if (value > std::get<std::string>(s.max)) {
+                    s.max = std::string(value);
+                }
+                break;
+            }
+        }
+    }
+}
+
+size_t FileManager::rowSpan(const Schema& schema, const char* row, size_t available) const {
+    size_t offset = 0;
+    
+    for (const auto& col : schema) {
+        switch (col.second) {
+            case INT: offset += sizeof(int); break;
+            case DOUBLE: offset += sizeof(double); break;
+            case STRING: {
+                if (offset + sizeof(uint32_t) > available) return 0;
+                uint32_t len;
+                std::memcpy(&len, row + offset, sizeof(uint32_t));
+                offset += sizeof(uint32_t) + len;
+                break;
+            }
+        }
+        if (offset > available) return 0;
+    }
+    
+    return offset;
+}
+
+uint64_t FileManager::hashKeyField(const Schema& schema, uint32_t column, const char* row) const {
+    size_t offset = 0;
+    
+    for (uint32_t col = 0; col <= column; col++) {
+        size_t width = 0;
+        switch (schema[col].second) {
+            case INT: width = sizeof(int); break;
+            case DOUBLE: width = sizeof(double); break;
+            case STRING: {
+                uint32_t len;
+                std::memcpy(&len, row + offset, sizeof(uint32_t));
+                width = sizeof(uint32_t) + len;
+                break;
+            }
+        }
         
-        if (rowSize == 0) {
-            std::cerr << "Warning: Row too large to fit in a single page, skipping\n";
-            continue;
+        if (col == column && schema[col].second == DOUBLE) {
+            double value;
+            std::memcpy(&value, row + offset, sizeof(double));
+            return hashDouble(value);
+        }
+        if (col == column) {
+            return hashFieldBytes(row + offset, width);
+        }
+        offset += width;
+    }
+    
+    return 0;
+}
+
+void FileManager::addPageFilter(
+    TableMetadata& metadata,
+    std::vector<uint64_t>& pageHashes,
+    std::vector<uint64_t>& allHashes)
+{
+    if (!metadata.bloom.enabled) return;
+    
+    BloomFilter filter(pageHashes.size(), metadata.bloom.bitsPerKey);
+    for (uint64_t hash : pageHashes) {
+        filter.insert(hash);
+    }
+    
+    metadata.bloom.pages.push_back(std::move(filter));
+    allHashes.insert(allHashes.end(), pageHashes.begin(), pageHashes.end());
+    pageHashes.clear();
+}
+
+void FileManager::buildTableFilter(TableMetadata& metadata, const std::vector<uint64_t>& allHashes) {
+    if (!metadata.bloom.enabled) return;
+    
+    metadata.bloom.table = BloomFilter(allHashes.size(), metadata.bloom.bitsPerKey);
+    for (uint64_t hash : allHashes) {
+        metadata.bloom.table.insert(hash);
+    }
+}
+
+void FileManager::refreshFilters(
+    std::fstream& file,
+    const Schema& schema,
+    const std::map<uint32_t, Page>& pages,
+    const std::vector<uint64_t>& newHashes,
+    TableMetadata& metadata)
+{
+    BloomIndex& bloom = metadata.bloom;
+    if (!bloom.enabled) return;
+    
+    auto pageHashes = [&](const Page& page) {
+        std::vector<uint64_t> hashes;
+        size_t offset = 0;
+        while (offset < page.used_bytes) {
+            size_t span = rowSpan(schema, page.getReadPtr(offset), page.used_bytes - offset);
+            if (span == 0) break;
+            hashes.push_back(hashKeyField(schema, bloom.keyColumn, page.getReadPtr(offset)));
+            offset += span;
+        }
+        return hashes;
+    };
+    
+    bloom.pages.resize(metadata.pageCount);
+    for (const auto& [pageNum, page] : pages) {
+        std::vector<uint64_t> hashes = pageHashes(page);
+        bloom.pages[pageNum - 1] = BloomFilter(hashes.size(), bloom.bitsPerKey);
+        for (uint64_t hash : hashes) {
+            bloom.pages[pageNum - 1].insert(hash);
+        }
+    }
+    
+    // Deleted keys cannot be removed from the table filter, only added; once it
+    // holds twice the keys it was sized for, rebuild it from the data pages.
+    // A table that had no filter yet (e.g. its first flush) has nothing to add to.
+    uint64_t capacity = bloom.table.sizeInBytes() * 8 / bloom.bitsPerKey;
+    bool rebuild = bloom.table.sizeInBytes() == 0 ||
+                   bloom.table.size() + newHashes.size() > 2 * std::max<uint64_t>(capacity, 1);
+    std::vector<uint64_t> allHashes;
+    
+    for (uint32_t pageNum = 1; rebuild && pageNum <= metadata.pageCount; pageNum++) {
+        auto it = pages.find(pageNum);
+        Page page;
+        if (it == pages.end() && !readDataPage(file, page, pageNum, metadata)) {
+            rebuild = false;
+            break;
         }
         
-        if (!currentPage.hasSpace(rowSize)) {
-            pageCount++;
-            writePage(file, currentPage, pageCount);
-            currentPage.clear();
+        std::vector<uint64_t> hashes = pageHashes(it == pages.end() ? page : it->second);
+        allHashes.insert(allHashes.end(), hashes.begin(), hashes.end());
+    }
+    
+    if (!rebuild) {
+        for (uint64_t hash : newHashes) {
+            bloom.table.insert(hash);
+        }
+        return;
+    }
+    
+    buildTableFilter(metadata, allHashes);
+}
+
+bool FileManager::write(
+    std::fstream& file,
+    const Schema& schema,
+    const TableData& tableData,
+    TableMetadata& metadata,
+    std::vector<uint32_t>* rowPages)
+{
+    return writeRows(file, schema, tableData.size(), [&](size_t i, char* buffer, size_t bufferSize) {
+        return serializeRow(tableData[i], buffer, bufferSize);
+    }, metadata, rowPages);
+}
+
+void FileManager::beginAppend(std::fstream& file, const Schema& schema, TableMetadata& metadata) {
+    file.clear();
+    
+    BloomIndex bloom;
+    bloom.enabled = metadata.bloom.enabled;
+    bloom.keyColumn = metadata.bloom.keyColumn;
+    bloom.bitsPerKey = metadata.bloom.bitsPerKey;
+    
+    metadata = TableMetadata();
+    metadata.schema = schema;
+    metadata.bloom = bloom;
+    
+    appendState = AppendState();
+    appendState.schema = schema;
+}
+
+void FileManager::writeAppended(std::fstream& file, size_t pageCount) {
+    AppendState& state = appendState;
+    
+    std::vector<std::pair<uint32_t, const char*>> pages;
+    for (size_t i = 0; i < pageCount; i++) {
+        pages.push_back({state.firstPage + i, state.pages.page(i)});
+    }
+    writeDataPages(file, pages);
+    
+    state.firstPage += pageCount;
+    state.pages = PageBuffer();
+}
+
+bool FileManager::append(std::fstream& file, const Row& row, TableMetadata& metadata) {
+    AppendState& state = appendState;
+    size_t open = state.pages.pageCount();
+    char* page = open > 0 ? state.pages.page(open - 1) : nullptr;
+    size_t rowSize = page ? serializeRow(row, page + state.used, PAGE_SIZE - state.used) : 0;
+    
+    if (rowSize == 0 && (page == nullptr || state.used > 0)) {
+        if (page != nullptr) {
+            addPageFilter(metadata, state.pageHashes, state.allHashes);
+            if (open >= APPEND_BATCH_PAGES) {
+                writeAppended(file, open);
+            }
         }
         
-        std::memcpy(currentPage.getWritePtr(), tempBuffer, rowSize);
-        currentPage.used_bytes += rowSize;
+        page = state.pages.append();
+        if (page == nullptr) {
+            std::cerr << "Warning: Failed to allocate page buffer, skipping row\n";
+            state.complete = false;
+            return false;
+        }
+        state.used = 0;
+        metadata.pages.emplace_back();
+        metadata.pages.back().stats.resize(state.schema.size());
+        rowSize = serializeRow(row, page, PAGE_SIZE);
+    }
+    
+    if (rowSize == 0) {
+        std::cerr << "Warning: Row too large to fit in a single page, skipping\n";
+        state.complete = false;
+        return false;
     }
     
-    if (currentPage.used_bytes > 0) {
-        pageCount++;
-        writePage(file, currentPage, pageCount);
+    PageInfo& info = metadata.pages.back();
+    accumulateStats(state.schema, page + state.used, rowSize, info.stats);
+    if (metadata.bloom.enabled) {
+        state.pageHashes.push_back(hashKeyField(state.schema, metadata.bloom.keyColumn, page + state.used));
     }
     
-    writeHeader(file, pageCount);
+    state.used += rowSize;
+    info.rowCount++;
+    info.usedBytes = state.used;
+    return true;
+}
+
+bool FileManager::finishAppend(std::fstream& file, TableMetadata& metadata) {
+    AppendState& state = appendState;
+    size_t pageCount = state.pages.pageCount();
+    
+    // Only a skipped last row leaves the open page empty
+    if (pageCount > 0 && metadata.pages.back().rowCount == 0) {
+        metadata.pages.pop_back();
+        pageCount--;
+    } else if (pageCount > 0) {
+        addPageFilter(metadata, state.pageHashes, state.allHashes);
+    }
+    
+    writeAppended(file, pageCount);
+    buildTableFilter(metadata, state.allHashes);
+    writeMetadata(file, metadata);
     
     file.flush();
+    bool complete = state.complete && file.good();
+    appendState = AppendState();
+    return complete;
 }
 
-void FileManager::read(std::fstream& file, const Schema& schema, TableData& tableData) {
-    file.clear();
+void FileManager::read(
+    std::fstream& file,
+    const Schema& schema,
+    TableData& tableData,
+    TableMetadata& metadata,
+    std::vector<uint32_t>* rowPages)
+{
     tableData.clear();
+    if (rowPages) {
+        rowPages->clear();
+    }
     
-    uint32_t pageCount = readHeader(file);
+    readRows(file, metadata, [&](const char* buffer, size_t bufferSize, uint32_t pageNum) {
+        Row row;
+        size_t bytesRead = deserializeRow(buffer, bufferSize, schema, row);
+        if (bytesRead > 0) {
+            tableData.push_back(std::move(row));
+            if (rowPages) {
+                rowPages->push_back(pageNum);
+            }
+        }
+        return bytesRead;
+    });
     
-    if (pageCount == 0) {
-        return;
+    if (metadata.version == LEGACY_FORMAT_VERSION) {
+        metadata.rowCount = tableData.size();
+    }
+}
+
+bool FileManager::readMetadata(std::fstream& file, TableMetadata& metadata) {
+    file.clear();
+    
+    if (!readHeader(file, metadata)) {
+        return false;
+    }
+    
+    if (metadata.version == LEGACY_FORMAT_VERSION) {
+        return true;
+    }
+    
+    // The directory and filters are decoded with the schema, so read it first
+    for (const auto& root : metadata.roots) {
+        if (root.kind != SCHEMA_OVERFLOW) continue;
+        
+        std::vector<char> schema;
+        if (!readBlob(file, root, metadata.version, schema)) {
+            std::cerr << "Warning: Failed to read schema\n";
+            return false;
+        }
+        
+        ByteReader reader{schema.data(), schema.size()};
+        if (!decodeSchema(reader, metadata)) {
+            return false;
+        }
     }
     
-    for (uint32_t pageNum = 1; pageNum <= pageCount; pageNum++) {
-        Page currentPage;
+    for (const auto& root : metadata.roots) {
+        if (root.kind == FREE_SPACE_MAP) {
+            std::vector<char> levels;
+            if (readBlob(file, root, metadata.version, levels)) {
+                metadata.freeSpace.deserialize(levels);
+            }
+            continue;
+        }
         
-        if (!readPage(file, currentPage, pageNum)) {
-            std::cerr << "Warning: Failed to read page " << pageNum << "\n";
+        if (root.kind == BLOOM_FILTER) {
+            std::vector<char> filters;
+            if (!readBlob(file, root, metadata.version, filters)) {
+                std::cerr << "Warning: Failed to read Bloom filters\n";
+                continue;
+            }
+            
+            ByteReader reader{filters.data(), filters.size()};
+            BloomIndex& bloom = metadata.bloom;
+            uint32_t pageFilters = 0;
+            bool ok = reader.get(bloom.keyColumn) &&
+                      reader.get(bloom.bitsPerKey) &&
+                      bloom.table.deserialize(filters.data(), filters.size(), reader.offset) &&
+                      reader.get(pageFilters);
+            
+            bloom.pages.resize(ok ? pageFilters : 0);
+            for (uint32_t i = 0; ok && i < pageFilters; i++) {
+                ok = bloom.pages[i].deserialize(filters.data(), filters.size(), reader.offset);
+            }
+            
+            bloom.enabled = ok && bloom.keyColumn < metadata.schema.size();
+            if (!bloom.enabled) {
+                metadata.bloom = BloomIndex();
+            }
             continue;
         }
         
-        size_t offset = 0;
+        if (root.kind != PAGE_DIRECTORY) continue;
+        
+        std::vector<char> directory;
+        if (!readBlob(file, root, metadata.version, directory)) {
+            std::cerr << "Warning: Failed to read page directory\n";
+            return true;
+        }
+        
+        ByteReader reader{directory.data(), directory.size()};
+        for (uint32_t i = 0; i < metadata.pageCount; i++) {
+            PageInfo page;
+            page.stats.resize(metadata.schema.size());
+            bool ok = reader.get(page.rowCount) && reader.get(page.usedBytes);
+            for (size_t col = 0; ok && col < metadata.schema.size(); col++) {
+                ok = reader.getStats(metadata.schema[col].second, page.stats[col]);
+            }
+            if (!ok) {
+                metadata.pages.clear();
+                break;
+            }
+            metadata.pages.push_back(std::move(page));
+        }
+    }
+    
+    // Files without a free-space map get one rebuilt from the directory
+    if (metadata.freeSpace.pageCount() != metadata.pageCount && metadata.pages.size() == metadata.pageCount) {
+        metadata.freeSpace.clear();
+        for (uint32_t i = 0; i < metadata.pageCount; i++) {
+            metadata.freeSpace.setFreeBytes(i + 1, PAGE_SIZE - metadata.pages[i].usedBytes);
+        }
+    }
+    
+    return true;
+}
+
+bool FileManager::supportsIncremental(const TableMetadata& metadata) const {
+    return metadata.version == FORMAT_VERSION &&
+           metadata.pages.size() == metadata.pageCount &&
+           metadata.freeSpace.pageCount() == metadata.pageCount &&
+           (!metadata.bloom.enabled || metadata.bloom.pages.size() == metadata.pageCount);
+}
+
+bool FileManager::preferIncremental(const TableMetadata& metadata, const std::vector<uint32_t>& rowPages) const {
+    if (metadata.pageCount == 0 || !supportsIncremental(metadata)) {
+        return false;
+    }
+
+    size_t unplaced = std::count(rowPages.begin(), rowPages.end(), 0u);
+    return unplaced * 2 <= rowPages.size();
+}
+
+bool FileManager::writeIncremental(
+    std::fstream& file,
+    const Schema& schema,
+    const TableData& tableData,
+    std::vector<uint32_t>& rowPages,
+    const std::set<uint32_t>& dirtyPages,
+    TableMetadata& metadata)
+{
+    file.clear();
+    rowPages.resize(tableData.size(), 0);
+    
+    std::map<uint32_t, Page> modified;
+    std::vector<size_t> pending;
+    std::vector<uint64_t> newHashes;
+    char tempBuffer[PAGE_SIZE];
+    
+    auto resetPage = [&](uint32_t pageNum) {
+        PageInfo& info = metadata.pages[pageNum - 1];
+        info = PageInfo();
+        info.stats.resize(schema.size());
+        modified[pageNum] = Page();
+    };
+    
+    auto append = [&](Page& page, uint32_t pageNum, size_t rowSize) {
+        std::memcpy(page.getWritePtr(), tempBuffer, rowSize);
+        page.used_bytes += rowSize;
         
-        while (offset < currentPage.used_bytes) {
-            Row row;
+        PageInfo& info = metadata.pages[pageNum - 1];
+        info.rowCount++;
+        info.usedBytes = page.used_bytes;
+        accumulateStats(schema, tempBuffer, rowSize, info.stats);
+        metadata.freeSpace.setFreeBytes(pageNum, PAGE_SIZE - page.used_bytes);
+    };
+    
+    for (uint32_t pageNum : dirtyPages) {
+        if (pageNum >= 1 && pageNum <= metadata.pageCount) {
+            resetPage(pageNum);
+            metadata.freeSpace.setFreeBytes(pageNum, PAGE_SIZE);
+        }
+    }
+    
+    // Dirty pages are rebuilt from the rows still assigned to them
+    for (size_t i = 0; i < tableData.size(); i++) {
+        uint32_t pageNum = rowPages[i];
+        if (pageNum == 0 || pageNum > metadata.pageCount) {
+            rowPages[i] = 0;
+            pending.push_back(i);
+            continue;
+        }
+        
+        auto it = modified.find(pageNum);
+        if (it == modified.end()) continue;
+        
+        size_t rowSize = serializeRow(tableData[i], tempBuffer, PAGE_SIZE);
+        if (rowSize == 0 || !it->second.hasSpace(rowSize)) {
+            rowPages[i] = 0;
+            pending.push_back(i);
+            continue;
+        }
+        
+        append(it->second, pageNum, rowSize);
+    }
+    
+    // New and relocated rows go wherever the free-space map has room
+    for (size_t i : pending) {
+        size_t rowSize = serializeRow(tableData[i], tempBuffer, PAGE_SIZE);
+        if (rowSize == 0) {
+            std::cerr << "Warning: Row too large to fit in a single page, skipping\n";
+            continue;
+        }
+        
+        // A stale map entry only costs a retry: the page is corrected and skipped
+        bool placed = false;
+        while (!placed) {
+            auto found = metadata.freeSpace.findPage(rowSize);
+            uint32_t pageNum;
             
-            size_t bytesRead = deserializeRow(
-                currentPage.getReadPtr(offset),
-                currentPage.used_bytes - offset,
-                schema,
-                row
-            );
+            if (found.has_value()) {
+                pageNum = *found;
+            } else {
+                metadata.pages.emplace_back();
+                metadata.pages.back().stats.resize(schema.size());
+                pageNum = ++metadata.pageCount;
+                modified[pageNum] = Page();
+            }
+            
+            auto it = modified.find(pageNum);
+            if (it == modified.end()) {
+                Page page;
+                if (!readDataPage(file, page, pageNum, metadata)) {
+                    std::cerr << "Warning: Failed to read page " << pageNum << "\n";
+                    metadata.freeSpace.setFreeBytes(pageNum, 0);
+                    continue;
+                }
+                it = modified.emplace(pageNum, page).first;
+            }
+            
+            if (!it->second.hasSpace(rowSize)) {
+                metadata.freeSpace.setFreeBytes(pageNum, PAGE_SIZE - it->second.used_bytes);
+                continue;
+            }
             
-            if (bytesRead == 0) break;
+            append(it->second, pageNum, rowSize);
+            rowPages[i] = pageNum;
+            placed = true;
             
-            tableData.push_back(row);
-            offset += bytesRead;
+            if (metadata.bloom.enabled) {
+                newHashes.push_back(hashKeyField(schema, metadata.bloom.keyColumn, tempBuffer));
+            }
         }
     }
+    
+    PageBuffer buffer;
+    std::vector<std::pair<uint32_t, const char*>> pages;
+    for (const auto& [pageNum, page] : modified) {
+        char* data = buffer.append();
+        if (data == nullptr) {
+            std::cerr << "Warning: Failed to allocate page buffer, nothing written\n";
+            return false;
+        }
+        std::memcpy(data, page.data.data(), page.used_bytes);
+    }
+    size_t index = 0;
+    for (const auto& entry : modified) {
+        pages.push_back({entry.first, buffer.page(index++)});
+    }
+    writeDataPages(file, pages);
+    
+    refreshFilters(file, schema, modified, newHashes, metadata);
+    writeMetadata(file, metadata);
+    
+    file.flush();
+    return true;
+}
+
+bool FileManager::readPageRows(
+    std::fstream& file,
+    const Schema& schema,
+    const TableMetadata& metadata,
+    uint32_t pageNum,
+    TableData& rows)
+{
+    Page page;
+    
+    if (!readDataPage(file, page, pageNum, metadata)) {
+        return false;
+    }
+    
+    size_t offset = 0;
+    while (offset < page.used_bytes) {
+        Row row;
+        size_t bytesRead = deserializeRow(page.getReadPtr(offset), page.used_bytes - offset, schema, row);
+        if (bytesRead == 0) break;
+        rows.push_back(std::move(row));
+        offset += bytesRead;
+    }
+    
+    return true;
 }
\ No newline at end of file
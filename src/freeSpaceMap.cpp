@@ -0,0 +1,78 @@
+#include "FreeSpaceMap.hpp"
+#include <algorithm>
+
+void FreeSpaceMap::rebuild() {
+    leaves = 1;
+    while (leaves < levels.size()) {
+        leaves *= 2;
+    }
+
+    tree.assign(2 * leaves, 0);
+    std::copy(levels.begin(), levels.end(), tree.begin() + leaves);
+    for (size_t i = leaves - 1; i > 0; i--) {
+        tree[i] = std::max(tree[2 * i], tree[2 * i + 1]);
+    }
+}
+
+void FreeSpaceMap::update(size_t index) {
+    size_t node = leaves + index;
+    tree[node] = levels[index];
+    for (node /= 2; node > 0; node /= 2) {
+        tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+    }
+}
+
+// Growing within the tree's capacity only exposes zero leaves, so pages
+// appended one at a time cost no rebuild
+void FreeSpaceMap::resize(size_t pageCount) {
+    bool shrinking = pageCount < levels.size();
+    levels.resize(pageCount, 0);
+    if (shrinking || pageCount > leaves) {
+        rebuild();
+    }
+}
+
+void FreeSpaceMap::clear() {
+    levels.clear();
+    rebuild();
+}
+
+size_t FreeSpaceMap::pageCount() const {
+    return levels.size();
+}
+
+void FreeSpaceMap::setFreeBytes(uint32_t pageNum, size_t freeBytes) {
+    if (pageNum == 0) return;
+    if (pageNum > levels.size()) {
+        resize(pageNum);
+    }
+    levels[pageNum - 1] = std::min<size_t>(freeBytes / BYTES_PER_LEVEL, 255);
+    update(pageNum - 1);
+}
+
+size_t FreeSpaceMap::freeBytes(uint32_t pageNum) const {
+    if (pageNum == 0 || pageNum > levels.size()) return 0;
+    return levels[pageNum - 1] * BYTES_PER_LEVEL;
+}
+
+std::optional<uint32_t> FreeSpaceMap::findPage(size_t bytesNeeded) const {
+    size_t needed = (bytesNeeded + BYTES_PER_LEVEL - 1) / BYTES_PER_LEVEL;
+    if (needed > 255 || levels.empty() || tree[1] < needed) return std::nullopt;
+
+    // Descend towards the leftmost leaf that is large enough
+    size_t node = 1;
+    while (node < leaves) {
+        node = (tree[2 * node] >= needed) ? 2 * node : 2 * node + 1;
+    }
+
+    return static_cast<uint32_t>(node - leaves + 1);
+}
+
+std::vector<char> FreeSpaceMap::serialize() const {
+    return std::vector<char>(levels.begin(), levels.end());
+}
+
+void FreeSpaceMap::deserialize(const std::vector<char>& bytes) {
+    levels.assign(bytes.begin(), bytes.end());
+    rebuild();
+}
@@ -0,0 +1,711 @@
+#include "LsmStore.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include "Sorter.hpp"
+
+namespace {
+
+template <typename T>
+void writeValue(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+Value defaultValue(SupportedTypes type) {
+    switch (type) {
+        case INT: return 0;
+        case DOUBLE: return 0.0;
+        case STRING: return std::string();
+    }
+    return 0;
+}
+
+}
+
+LsmStore::Run::~Run() {
+    if (file.is_open()) {
+        file.close();
+    }
+    if (obsolete) {
+        std::remove(filename.c_str());
+    }
+}
+
+LsmStore::LsmStore(
+    const std::string& path,
+    std::ios::openmode mode,
+    const Schema& schema,
+    const LsmOptions& options)
+    : path(path), schema(schema), runSchema(schema), options(options) {
+    runSchema.push_back({"__tombstone", INT});
+
+    if (this->options.keyColumn >= schema.size()) {
+        std::cerr << "Warning: LSM key column out of range, using column 0\n";
+        this->options.keyColumn = 0;
+    }
+
+    // Truncating drops the runs of whatever table used this path before
+    bool truncate = mode & std::ios::trunc;
+    if (!loadManifest(!truncate) || truncate) {
+        levels.clear();
+        nextRunId = 1;
+        saveManifest();
+    }
+
+    if (this->options.backgroundCompaction) {
+        compactor = std::thread(&LsmStore::compactionLoop, this);
+    }
+}
+
+LsmStore::~LsmStore() {
+    flush();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    compactionSignal.notify_all();
+
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+}
+
+bool LsmStore::validateRow(const Row& row) const {
+    if (row.size() != schema.size()) return false;
+
+    for (size_t i = 0; i < schema.size(); i++) {
+        if (row[i].index() != static_cast<size_t>(schema[i].second)) return false;
+    }
+
+    return true;
+}
+
+std::string LsmStore::runFilename(uint64_t id) const {
+    return path + ".run." + std::to_string(id);
+}
+
+bool LsmStore::loadManifest(bool openRuns) {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    uint32_t magic = 0, version = 0, levelCount = 0;
+    if (!readValue(in, magic) || magic != LSM_MANIFEST_MAGIC ||
+        !readValue(in, version) || version > LSM_MANIFEST_VERSION ||
+        !readValue(in, nextRunId) || !readValue(in, levelCount)) {
+        return false;
+    }
+
+    levels.assign(levelCount, {});
+    for (uint32_t level = 0; level < levelCount; level++) {
+        uint32_t runCount = 0;
+        if (!readValue(in, runCount)) return false;
+
+        for (uint32_t i = 0; i < runCount; i++) {
+            uint64_t id = 0;
+            if (!readValue(in, id)) return false;
+
+            if (!openRuns) {
+                std::remove(runFilename(id).c_str());
+                continue;
+            }
+
+            RunPtr run = openRun(id);
+            if (run == nullptr) {
+                std::cerr << "Warning: Cannot open LSM run " << runFilename(id) << "\n";
+                continue;
+            }
+            levels[level].push_back(run);
+        }
+    }
+
+    return true;
+}
+
+// Written to a temporary file and renamed so a crash leaves the old manifest
+bool LsmStore::saveManifest() const {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        writeValue(out, LSM_MANIFEST_MAGIC);
+        writeValue(out, LSM_MANIFEST_VERSION);
+        writeValue(out, nextRunId);
+        writeValue(out, static_cast<uint32_t>(levels.size()));
+
+        for (const auto& level : levels) {
+            writeValue(out, static_cast<uint32_t>(level.size()));
+            for (const auto& run : level) {
+                writeValue(out, run->id);
+            }
+        }
+
+        if (!out.good()) {
+            return false;
+        }
+    }
+
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+LsmStore::RunPtr LsmStore::openRun(uint64_t id) {
+    auto run = std::make_shared<Run>();
+    run->id = id;
+    run->filename = runFilename(id);
+    run->file.open(run->filename, std::ios::in | std::ios::out | std::ios::binary);
+
+    if (!run->file.is_open() || !fileManager.readMetadata(run->file, run->metadata) ||
+        run->metadata.schema != runSchema) {
+        return nullptr;
+    }
+
+    return run;
+}
+
+LsmStore::RunPtr LsmStore::writeRun(const std::function<bool(Row&)>& next) {
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextRunId++;
+    }
+
+    auto run = std::make_shared<Run>();
+    run->id = id;
+    run->filename = runFilename(id);
+    run->file.open(run->filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!run->file.is_open()) {
+        std::cerr << "Warning: Failed to create LSM run " << run->filename << "\n";
+        return nullptr;
+    }
+
+    run->metadata.bloom.enabled = true;
+    run->metadata.bloom.keyColumn = options.keyColumn;
+    run->metadata.bloom.bitsPerKey = options.bitsPerKey;
+
+    FileManager writer(run->filename);
+    writer.beginAppend(run->file, runSchema, run->metadata);
+
+    bool complete = true;
+    Row row;
+    while (next(row)) {
+        complete = writer.append(run->file, row, run->metadata) && complete;
+    }
+    complete = writer.finishAppend(run->file, run->metadata) && complete;
+
+    if (!complete) {
+        std::cerr << "Warning: Failed to write LSM run " << run->filename << "\n";
+        run->obsolete = true;
+        return nullptr;
+    }
+
+    return run;
+}
+
+void LsmStore::flushMemtable(bool onlyIfFull) {
+    std::lock_guard<std::mutex> flushLock(flushMutex);
+    std::shared_ptr<const Memtable> frozen;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (memtable.empty() || (onlyIfFull && memtableBytes < options.memtableBytes)) {
+            return;
+        }
+
+        frozen = std::make_shared<const Memtable>(std::move(memtable));
+        memtable.clear();
+        memtableBytes = 0;
+        flushing = frozen;
+    }
+
+    // Writers keep filling the new memtable while the run is written
+    auto next = frozen->begin();
+    RunPtr run = writeRun([&](Row& row) {
+        if (next == frozen->end()) return false;
+        row = next->second.row;
+        row.push_back(next->second.deleted ? 1 : 0);
+        ++next;
+        return true;
+    });
+
+    std::lock_guard<std::mutex> lock(mutex);
+    flushing.reset();
+
+    if (run == nullptr) {
+        // Keep the rows; anything written since is newer and wins
+        for (const auto& [key, entry] : *frozen) {
+            if (memtable.emplace(key, entry).second) {
+                memtableBytes += Sorter::rowFootprint(entry.row);
+            }
+        }
+        return;
+    }
+
+    if (levels.empty()) {
+        levels.emplace_back();
+    }
+    levels[0].push_back(run);
+    saveManifest();
+    stats.flushes++;
+    compactionFailed = false;
+
+    compactionSignal.notify_one();
+}
+
+bool LsmStore::storeInMemtable(const Value& key, Entry entry) {
+    size_t bytes = Sorter::rowFootprint(entry.row);
+    auto [it, inserted] = memtable.try_emplace(key);
+    if (!inserted) {
+        memtableBytes -= Sorter::rowFootprint(it->second.row);
+    }
+    it->second = std::move(entry);
+    memtableBytes += bytes;
+    return memtableBytes >= options.memtableBytes;
+}
+
+bool LsmStore::put(const Row& row) {
+    if (!validateRow(row)) {
+        return false;
+    }
+
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        full = storeInMemtable(row[options.keyColumn], Entry{row, false});
+    }
+
+    if (full) {
+        flushMemtable(true);
+        if (!options.backgroundCompaction) {
+            compact();
+        }
+    }
+
+    return true;
+}
+
+bool LsmStore::remove(const Value& key) {
+    if (key.index() != static_cast<size_t>(schema[options.keyColumn].second)) {
+        return false;
+    }
+
+    Row tombstone;
+    for (const auto& col : schema) {
+        tombstone.push_back(defaultValue(col.second));
+    }
+    tombstone[options.keyColumn] = key;
+
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        full = storeInMemtable(key, Entry{tombstone, true});
+    }
+
+    if (full) {
+        flushMemtable(true);
+        if (!options.backgroundCompaction) {
+            compact();
+        }
+    }
+
+    return true;
+}
+
+std::optional<LsmStore::Entry> LsmStore::searchRun(Run& run, const Value& key, uint64_t hash) {
+    stats.runProbes++;
+
+    const TableMetadata& metadata = run.metadata;
+    const BloomIndex& bloom = metadata.bloom;
+    size_t col = options.keyColumn;
+
+    if (bloom.enabled && !bloom.table.mayContain(hash)) {
+        stats.bloomSkips++;
+        return std::nullopt;
+    }
+
+    // Pages of a run hold ascending keys, so their zone maps are fence pointers
+    const auto& pages = metadata.pages;
+    size_t lo = 0, hi = pages.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (pages[mid].stats[col].hasValue && pages[mid].stats[col].max < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == pages.size() || !pages[lo].stats[col].hasValue || key < pages[lo].stats[col].min) {
+        stats.fenceSkips++;
+        return std::nullopt;
+    }
+
+    if (bloom.pages.size() == pages.size() && !bloom.pages[lo].mayContain(hash)) {
+        stats.bloomSkips++;
+        return std::nullopt;
+    }
+
+    TableData rows;
+    {
+        std::lock_guard<std::mutex> lock(run.ioMutex);
+        if (!fileManager.readPageRows(run.file, runSchema, run.metadata, lo + 1, rows)) {
+            return std::nullopt;
+        }
+    }
+    stats.pageReads++;
+
+    auto it = std::lower_bound(rows.begin(), rows.end(), key, [col](const Row& row, const Value& k) {
+        return row[col] < k;
+    });
+    if (it == rows.end() || (*it)[col] != key) {
+        return std::nullopt;
+    }
+
+    Entry entry;
+    entry.deleted = std::get<int>(it->back()) != 0;
+    entry.row = std::move(*it);
+    entry.row.pop_back();
+    return entry;
+}
+
+std::optional<Row> LsmStore::get(const Value& key) {
+    if (key.index() != static_cast<size_t>(schema[options.keyColumn].second)) {
+        return std::nullopt;
+    }
+
+    std::vector<RunPtr> runs;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (const Memtable* table : {static_cast<const Memtable*>(&memtable), flushing.get()}) {
+            if (table == nullptr) continue;
+            auto it = table->find(key);
+            if (it != table->end()) {
+                if (it->second.deleted) return std::nullopt;
+                return it->second.row;
+            }
+        }
+
+        // Newest first: level 0 before deeper levels, later runs before earlier
+        for (const auto& level : levels) {
+            runs.insert(runs.end(), level.rbegin(), level.rend());
+        }
+    }
+
+    uint64_t hash = hashValue(key);
+    for (const auto& run : runs) {
+        auto entry = searchRun(*run, key, hash);
+        if (entry.has_value()) {
+            if (entry->deleted) return std::nullopt;
+            return entry->row;
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool LsmStore::fillCursor(MergeCursor& cursor) {
+    while (cursor.pos == cursor.entries.size() && cursor.run &&
+           cursor.nextPage <= cursor.run->metadata.pageCount) {
+        TableData rows;
+        {
+            std::lock_guard<std::mutex> lock(cursor.run->ioMutex);
+            if (!fileManager.readPageRows(cursor.run->file, runSchema, cursor.run->metadata, cursor.nextPage, rows)) {
+                std::cerr << "Warning: Failed to read page " << cursor.nextPage
+                          << " of LSM run " << cursor.run->filename << "\n";
+                return false;
+            }
+        }
+        cursor.nextPage++;
+
+        cursor.entries.clear();
+        cursor.pos = 0;
+        for (auto& row : rows) {
+            Entry entry;
+            entry.deleted = std::get<int>(row.back()) != 0;
+            row.pop_back();
+            entry.row = std::move(row);
+            cursor.entries.push_back(std::move(entry));
+        }
+    }
+    return true;
+}
+
+bool LsmStore::nextMerged(std::vector<MergeCursor>& cursors, Entry& entry, bool& failed) {
+    size_t col = options.keyColumn;
+    MergeCursor* best = nullptr;
+
+    // Each input holds a key at most once; later (newer) inputs win ties
+    for (auto& cursor : cursors) {
+        if (!fillCursor(cursor)) {
+            failed = true;
+            return false;
+        }
+        if (cursor.pos == cursor.entries.size()) continue;
+
+        if (best == nullptr || !(best->entries[best->pos].row[col] < cursor.entries[cursor.pos].row[col])) {
+            best = &cursor;
+        }
+    }
+
+    if (best == nullptr) {
+        return false;
+    }
+
+    Value key = best->entries[best->pos].row[col];
+    for (auto& cursor : cursors) {
+        if (&cursor != best && cursor.pos < cursor.entries.size() && cursor.entries[cursor.pos].row[col] == key) {
+            cursor.pos++;
+        }
+    }
+
+    entry = std::move(best->entries[best->pos]);
+    best->pos++;
+    return true;
+}
+
+std::vector<LsmStore::MergeCursor> LsmStore::allCursors() const {
+    std::vector<MergeCursor> cursors;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Oldest first: deepest level first, then the memtables
+    for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+        for (const auto& run : *level) {
+            cursors.emplace_back();
+            cursors.back().run = run;
+        }
+    }
+    for (const Memtable* table : {flushing.get(), &memtable}) {
+        if (table == nullptr) continue;
+        MergeCursor cursor;
+        for (const auto& [key, entry] : *table) {
+            cursor.entries.push_back(entry);
+        }
+        cursors.push_back(std::move(cursor));
+    }
+
+    return cursors;
+}
+
+TableData LsmStore::scan() {
+    TableData result;
+    scan([&result](const Row& row) {
+        result.push_back(row);
+        return true;
+    });
+    return result;
+}
+
+bool LsmStore::scan(const std::function<bool(const Row&)>& visit) {
+    std::vector<MergeCursor> cursors = allCursors();
+
+    Entry entry;
+    bool failed = false;
+    while (nextMerged(cursors, entry, failed)) {
+        if (!entry.deleted && !visit(entry.row)) break;
+    }
+
+    return !failed;
+}
+
+size_t LsmStore::rowCount() {
+    std::vector<MergeCursor> cursors = allCursors();
+
+    size_t count = 0;
+    Entry entry;
+    bool failed = false;
+    while (nextMerged(cursors, entry, failed)) {
+        if (!entry.deleted) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+uint64_t LsmStore::entryCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t count = memtable.size() + (flushing ? flushing->size() : 0);
+    for (const auto& level : levels) {
+        for (const auto& run : level) {
+            count += run->metadata.rowCount;
+        }
+    }
+    return count;
+}
+
+void LsmStore::flush() {
+    flushMemtable(false);
+}
+
+int LsmStore::levelNeedingCompaction() const {
+    if (compactionFailed) {
+        return -1;
+    }
+
+    for (size_t level = 0; level < levels.size(); level++) {
+        if (levels[level].size() >= std::max<size_t>(options.runsPerLevel, 2)) {
+            return static_cast<int>(level);
+        }
+    }
+    return -1;
+}
+
+// Merges every run of `level` into one run appended to level + 1. Inputs are
+// newer than anything already on level + 1, so the output goes last there.
+// Tombstones are dropped once no deeper level can hold an older version.
+bool LsmStore::compactLevel(size_t level) {
+    std::lock_guard<std::mutex> compactionLock(compactionMutex);
+    std::vector<RunPtr> inputs;
+    bool bottom = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (level >= levels.size()) return true;
+        inputs = levels[level];
+        for (size_t deeper = level + 1; deeper < levels.size(); deeper++) {
+            bottom = bottom && levels[deeper].empty();
+        }
+    }
+
+    if (inputs.empty()) {
+        return true;
+    }
+
+    // Streams the inputs page by page, so memory does not grow with the level
+    std::vector<MergeCursor> cursors;
+    for (const auto& input : inputs) {
+        cursors.emplace_back();
+        cursors.back().run = input;
+    }
+
+    bool failed = false;
+    RunPtr run = writeRun([&](Row& row) {
+        Entry entry;
+        while (nextMerged(cursors, entry, failed)) {
+            if (entry.deleted && bottom) continue;
+            row = std::move(entry.row);
+            row.push_back(entry.deleted ? 1 : 0);
+            return true;
+        }
+        return false;
+    });
+
+    // Every key was dropped as a tombstone
+    bool empty = !failed && run != nullptr && run->metadata.rowCount == 0;
+    if (run != nullptr && (failed || empty)) {
+        run->obsolete = true;
+        run = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (run == nullptr && !empty) {
+        // The inputs are still the only copy of these rows
+        compactionFailed = true;
+        return false;
+    }
+
+    auto& source = levels[level];
+    for (const auto& input : inputs) {
+        source.erase(std::remove(source.begin(), source.end(), input), source.end());
+        input->obsolete = true;
+    }
+
+    if (run != nullptr) {
+        if (levels.size() <= level + 1) {
+            levels.resize(level + 2);
+        }
+        levels[level + 1].push_back(run);
+    }
+
+    while (!levels.empty() && levels.back().empty()) {
+        levels.pop_back();
+    }
+
+    saveManifest();
+    stats.compactions++;
+    return true;
+}
+
+void LsmStore::compactionLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        compactionSignal.wait(lock, [this] {
+            return stopping || levelNeedingCompaction() >= 0;
+        });
+        if (stopping) break;
+
+        int level = levelNeedingCompaction();
+        compacting = true;
+        lock.unlock();
+        compactLevel(level);
+        lock.lock();
+        compacting = false;
+        compactionDone.notify_all();
+    }
+
+    compactionDone.notify_all();
+}
+
+bool LsmStore::compact() {
+    if (options.backgroundCompaction) {
+        compactionSignal.notify_one();
+        waitForCompaction();
+        std::lock_guard<std::mutex> lock(mutex);
+        return !compactionFailed;
+    }
+
+    while (true) {
+        int level;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            level = levelNeedingCompaction();
+        }
+        if (level < 0) break;
+        if (!compactLevel(level)) return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return !compactionFailed;
+}
+
+void LsmStore::waitForCompaction() {
+    if (!options.backgroundCompaction) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    compactionDone.wait(lock, [this] {
+        return stopping || (!compacting && levelNeedingCompaction() < 0);
+    });
+}
+
+std::vector<size_t> LsmStore::levelSizes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<size_t> sizes;
+    for (const auto& level : levels) {
+        sizes.push_back(level.size());
+    }
+    return sizes;
+}
+
+const LsmStats& LsmStore::getStats() const {
+    return stats;
+}
+
+const Schema& LsmStore::getSchema() const {
+    return schema;
+}
+
+size_t LsmStore::getKeyColumn() const {
+    return options.keyColumn;
+}
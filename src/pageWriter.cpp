@@ -0,0 +1,161 @@
+#include "PageWriter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+PageBuffer::~PageBuffer() {
+    std::free(pages);
+}
+
+PageBuffer::PageBuffer(PageBuffer&& other) noexcept
+    : pages(other.pages), count(other.count), capacity(other.capacity) {
+    other.pages = nullptr;
+    other.count = other.capacity = 0;
+}
+
+PageBuffer& PageBuffer::operator=(PageBuffer&& other) noexcept {
+    if (this != &other) {
+        std::free(pages);
+        pages = other.pages;
+        count = other.count;
+        capacity = other.capacity;
+        other.pages = nullptr;
+        other.count = other.capacity = 0;
+    }
+    return *this;
+}
+
+char* PageBuffer::append() {
+    if (count == capacity) {
+        size_t grown = std::max<size_t>(capacity * 2, 8);
+        char* larger = static_cast<char*>(std::aligned_alloc(PAGE_SIZE, grown * PAGE_SIZE));
+        if (larger == nullptr) {
+            return nullptr;
+        }
+        if (count > 0) {
+            std::memcpy(larger, pages, count * PAGE_SIZE);
+        }
+        std::free(pages);
+        pages = larger;
+        capacity = grown;
+    }
+
+    char* fresh = page(count++);
+    std::memset(fresh, 0, PAGE_SIZE);
+    return fresh;
+}
+
+#ifdef __linux__
+
+PageWriter::PageWriter(const std::string& path) {
+    if (path.empty()) {
+        return;
+    }
+
+    fd = open(path.c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC);
+    direct = fd >= 0;
+
+    // tmpfs and some network filesystems reject O_DIRECT
+    if (fd < 0 && errno == EINVAL) {
+        fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    }
+}
+
+PageWriter::~PageWriter() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool PageWriter::isOpen() const {
+    return fd >= 0;
+}
+
+bool PageWriter::usesDirectIo() const {
+    return direct;
+}
+
+void PageWriter::add(uint64_t offset, const char* page) {
+    queued.push_back({offset, page});
+}
+
+bool PageWriter::flush() {
+    std::sort(queued.begin(), queued.end());
+    bool ok = true;
+
+    std::vector<iovec> iov;
+    size_t i = 0;
+    while (ok && i < queued.size()) {
+        uint64_t start = queued[i].first;
+        iov.clear();
+
+        // One call per run of adjacent pages, up to IOV_MAX iovecs
+        while (i < queued.size() && iov.size() < IOV_MAX &&
+               queued[i].first == start + iov.size() * PAGE_SIZE) {
+            iov.push_back({const_cast<char*>(queued[i].second), PAGE_SIZE});
+            i++;
+        }
+
+        size_t remaining = iov.size() * PAGE_SIZE;
+        uint64_t offset = start;
+        size_t first = 0;
+        while (remaining > 0) {
+            ssize_t written = pwritev(fd, iov.data() + first, iov.size() - first, offset);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) {
+                std::cerr << "Warning: Page write failed: " << std::strerror(errno) << "\n";
+                ok = false;
+                break;
+            }
+
+            // Short writes end on a page boundary for whole-page O_DIRECT I/O;
+            // otherwise the partial iovec is finished by the next call
+            remaining -= written;
+            offset += written;
+            while (written > 0) {
+                size_t step = std::min<size_t>(written, iov[first].iov_len);
+                iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + step;
+                iov[first].iov_len -= step;
+                written -= step;
+                if (iov[first].iov_len == 0) first++;
+            }
+        }
+    }
+
+    queued.clear();
+    return ok;
+}
+
+#else
+
+PageWriter::PageWriter(const std::string&) {}
+
+PageWriter::~PageWriter() {}
+
+bool PageWriter::isOpen() const {
+    return false;
+}
+
+bool PageWriter::usesDirectIo() const {
+    return false;
+}
+
+void PageWriter::add(uint64_t offset, const char* page) {
+    queued.push_back({offset, page});
+}
+
+bool PageWriter::flush() {
+    queued.clear();
+    return false;
+}
+
+#endif
@@ -0,0 +1,396 @@
+#include "Protocol.hpp"
+#include <cstring>
+#include "FileManager.hpp"
+
+namespace {
+
+template <typename T>
+void put(std::vector<char>& out, T value) {
+    size_t offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+void putString(std::vector<char>& out, const std::string& s) {
+    put<uint32_t>(out, s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+size_t encodedSize(const Row& row) {
+    size_t size = 0;
+    for (const auto& field : row) {
+        if (std::holds_alternative<int>(field)) size += sizeof(int);
+        else if (std::holds_alternative<double>(field)) size += sizeof(double);
+        else size += sizeof(uint32_t) + std::get<std::string>(field).size();
+    }
+    return size;
+}
+
+bool putRow(std::vector<char>& out, const Row& row) {
+    static thread_local FileManager fileManager;
+
+    size_t offset = out.size();
+    size_t size = encodedSize(row);
+    out.resize(offset + size);
+    if (size > 0 && fileManager.serializeRow(row, out.data() + offset, size) != size) {
+        out.resize(offset);
+        return false;
+    }
+    return true;
+}
+
+// A lone field is a one-column row prefixed with its type
+bool putValue(std::vector<char>& out, const Value& value) {
+    put<uint8_t>(out, value.index());
+    return putRow(out, Row{value});
+}
+
+bool putRows(std::vector<char>& out, const TableData& rows) {
+    size_t columns = rows.empty() ? 0 : rows[0].size();
+    put<uint32_t>(out, columns);
+    for (size_t i = 0; i < columns; i++) {
+        put<uint8_t>(out, rows[0][i].index());
+    }
+
+    put<uint32_t>(out, rows.size());
+    for (const auto& row : rows) {
+        if (row.size() != columns) return false;
+        for (size_t i = 0; i < columns; i++) {
+            if (row[i].index() != rows[0][i].index()) return false;
+        }
+        if (!putRow(out, row)) return false;
+    }
+    return true;
+}
+
+void putConditions(std::vector<char>& out, const std::vector<Condition>& where) {
+    put<uint32_t>(out, where.size());
+    for (const auto& cond : where) {
+        put<uint32_t>(out, cond.column);
+        put<uint8_t>(out, cond.op);
+        putValue(out, cond.value);
+    }
+}
+
+class ByteReader {
+    private:
+        const char* data;
+        size_t size;
+        size_t offset = 0;
+
+    public:
+        ByteReader(const char* data, size_t size) : data(data), size(size) {}
+
+        template <typename T>
+        bool get(T& value) {
+            if (offset + sizeof(T) > size) return false;
+            std::memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        bool getString(std::string& s) {
+            uint32_t len;
+            if (!get(len) || offset + len > size) return false;
+            s.assign(data + offset, len);
+            offset += len;
+            return true;
+        }
+
+        bool getRow(const Schema& schema, Row& row) {
+            static thread_local FileManager fileManager;
+            size_t used = fileManager.deserializeRow(data + offset, size - offset, schema, row);
+            if (used == 0) return false;
+            offset += used;
+            return true;
+        }
+
+        bool getType(SupportedTypes& type) {
+            uint8_t tag;
+            if (!get(tag) || tag > STRING) return false;
+            type = static_cast<SupportedTypes>(tag);
+            return true;
+        }
+
+        bool getValue(Value& value) {
+            SupportedTypes type;
+            Row row;
+            if (!getType(type) || !getRow({{"", type}}, row)) return false;
+            value = std::move(row[0]);
+            return true;
+        }
+
+        bool getRows(TableData& rows) {
+            uint32_t columns, count;
+            if (!get(columns) || columns > size - offset) return false;
+
+            Schema schema(columns);
+            for (auto& col : schema) {
+                if (!getType(col.second)) return false;
+            }
+
+            // Every row takes at least one byte, so the count is bounded by the frame
+            if (!get(count) || (count > 0 && (columns == 0 || count > size - offset))) return false;
+            rows.clear();
+            rows.reserve(count);
+            for (uint32_t i = 0; i < count; i++) {
+                Row row;
+                if (!getRow(schema, row)) return false;
+                rows.push_back(std::move(row));
+            }
+            return true;
+        }
+
+        bool getConditions(std::vector<Condition>& where) {
+            uint32_t count;
+            if (!get(count) || count > size - offset) return false;
+
+            where.resize(count);
+            for (auto& cond : where) {
+                uint32_t column;
+                uint8_t op;
+                if (!get(column) || !get(op) || op > CMP_GE || !getValue(cond.value)) return false;
+                cond.column = column;
+                cond.op = static_cast<CompareOp>(op);
+            }
+            return true;
+        }
+
+        bool done() const { return offset == size; }
+};
+
+// Reserves the length prefix and writes the id and opcode/status
+size_t beginFrame(std::vector<char>& out, uint32_t id, uint8_t tag) {
+    size_t start = out.size();
+    put<uint32_t>(out, 0);
+    put<uint32_t>(out, id);
+    put<uint8_t>(out, tag);
+    return start;
+}
+
+bool endFrame(std::vector<char>& out, size_t start, bool ok) {
+    size_t length = out.size() - start - sizeof(uint32_t);
+    if (!ok || length > MAX_FRAME_SIZE) {
+        out.resize(start);
+        return false;
+    }
+
+    uint32_t length32 = length;
+    std::memcpy(out.data() + start, &length32, sizeof(uint32_t));
+    return true;
+}
+
+}
+
+FrameState nextFrame(const char* data, size_t size, size_t& frameSize) {
+    if (size < sizeof(uint32_t)) return FRAME_INCOMPLETE;
+
+    uint32_t length;
+    std::memcpy(&length, data, sizeof(uint32_t));
+    if (length < FRAME_HEADER_SIZE - sizeof(uint32_t) || length > MAX_FRAME_SIZE) {
+        return FRAME_INVALID;
+    }
+
+    frameSize = sizeof(uint32_t) + length;
+    return size >= frameSize ? FRAME_READY : FRAME_INCOMPLETE;
+}
+
+bool encodeRequest(const Request& request, std::vector<char>& out) {
+    size_t start = beginFrame(out, request.id, request.op);
+    bool ok = true;
+
+    if (request.op != OP_PING) {
+        putString(out, request.table);
+    }
+
+    switch (request.op) {
+        case OP_INSERT:
+            ok = putRows(out, request.rows);
+            break;
+        case OP_GET:
+            ok = putValue(out, request.key);
+            break;
+        case OP_SELECT:
+            putConditions(out, request.query.where);
+            put<uint32_t>(out, request.query.columns.size());
+            for (size_t col : request.query.columns) {
+                put<uint32_t>(out, col);
+            }
+            put<uint64_t>(out, request.query.limit);
+            break;
+        case OP_AGGREGATE:
+            putConditions(out, request.query.where);
+            put<uint32_t>(out, request.aggregates.size());
+            for (const auto& agg : request.aggregates) {
+                put<uint8_t>(out, agg.op);
+                put<uint32_t>(out, agg.column);
+            }
+            break;
+        default:
+            break;
+    }
+
+    return endFrame(out, start, ok);
+}
+
+bool decodeRequest(const char* frame, size_t frameSize, Request& request) {
+    ByteReader in(frame, frameSize);
+    uint32_t length;
+    uint8_t op;
+    if (!in.get(length) || !in.get(request.id) || !in.get(op) || op < OP_PING || op > OP_FLUSH) {
+        return false;
+    }
+    request.op = static_cast<Opcode>(op);
+
+    if (request.op != OP_PING && !in.getString(request.table)) {
+        return false;
+    }
+
+    switch (request.op) {
+        case OP_INSERT:
+            if (!in.getRows(request.rows)) return false;
+            break;
+        case OP_GET:
+            if (!in.getValue(request.key)) return false;
+            break;
+        case OP_SELECT: {
+            uint32_t columns;
+            uint64_t limit;
+            if (!in.getConditions(request.query.where) || !in.get(columns)) return false;
+            request.query.columns.clear();
+            for (uint32_t i = 0; i < columns; i++) {
+                uint32_t col;
+                if (!in.get(col)) return false;
+                request.query.columns.push_back(col);
+            }
+            if (!in.get(limit)) return false;
+            request.query.limit = limit;
+            break;
+        }
+        case OP_AGGREGATE: {
+            uint32_t count;
+            if (!in.getConditions(request.query.where) || !in.get(count)) return false;
+            request.aggregates.clear();
+            for (uint32_t i = 0; i < count; i++) {
+                uint8_t aggOp;
+                uint32_t column;
+                if (!in.get(aggOp) || !in.get(column) || aggOp > AGG_AVG) return false;
+                request.aggregates.push_back({static_cast<AggregateOp>(aggOp), column});
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    return in.done();
+}
+
+bool encodeResponse(const Response& response, Opcode op, std::vector<char>& out) {
+    size_t start = beginFrame(out, response.id, response.status);
+    bool ok = true;
+
+    if (response.status != STATUS_OK) {
+        putString(out, response.error);
+        return endFrame(out, start, true);
+    }
+
+    switch (op) {
+        case OP_SCHEMA:
+            put<uint32_t>(out, response.schema.size());
+            for (const auto& col : response.schema) {
+                putString(out, col.first);
+                put<uint8_t>(out, col.second);
+            }
+            break;
+        case OP_INSERT:
+            put<uint64_t>(out, response.count);
+            break;
+        case OP_GET:
+        case OP_SELECT:
+            ok = putRows(out, response.rows);
+            break;
+        case OP_AGGREGATE:
+            put<uint32_t>(out, response.values.size());
+            for (const auto& value : response.values) {
+                put<uint8_t>(out, value.has_value());
+                if (value.has_value()) {
+                    putValue(out, *value);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Unencodable rows (e.g. oversized strings) and results over the frame
+    // limit become an error, so the client still gets a reply for this id
+    bool tooLarge = out.size() - start - sizeof(uint32_t) > MAX_FRAME_SIZE;
+    if (!ok || tooLarge) {
+        out.resize(start);
+        Response error;
+        error.id = response.id;
+        error.status = STATUS_ERROR;
+        error.error = tooLarge ? "result too large" : "response rows cannot be encoded";
+        return encodeResponse(error, op, out);
+    }
+
+    return endFrame(out, start, true);
+}
+
+bool decodeResponse(const char* frame, size_t frameSize, Opcode op, Response& response) {
+    ByteReader in(frame, frameSize);
+    uint32_t length;
+    uint8_t status;
+    if (!in.get(length) || !in.get(response.id) || !in.get(status) || status > STATUS_ERROR) {
+        return false;
+    }
+    response.status = static_cast<Status>(status);
+
+    if (response.status != STATUS_OK) {
+        return in.getString(response.error) && in.done();
+    }
+
+    switch (op) {
+        case OP_SCHEMA: {
+            uint32_t columns;
+            if (!in.get(columns)) return false;
+            response.schema.clear();
+            for (uint32_t i = 0; i < columns; i++) {
+                std::string name;
+                SupportedTypes type;
+                if (!in.getString(name) || !in.getType(type)) return false;
+                response.schema.push_back({name, type});
+            }
+            break;
+        }
+        case OP_INSERT:
+            if (!in.get(response.count)) return false;
+            break;
+        case OP_GET:
+        case OP_SELECT:
+            if (!in.getRows(response.rows)) return false;
+            break;
+        case OP_AGGREGATE: {
+            uint32_t count;
+            if (!in.get(count)) return false;
+            response.values.clear();
+            for (uint32_t i = 0; i < count; i++) {
+                uint8_t present;
+                if (!in.get(present)) return false;
+                if (!present) {
+                    response.values.push_back(std::nullopt);
+                    continue;
+                }
+                Value value;
+                if (!in.getValue(value)) return false;
+                response.values.push_back(std::move(value));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    return in.done();
+}
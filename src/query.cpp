@@ -0,0 +1,383 @@
+#include "Query.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+double numeric(const Value& value) {
+    if (std::holds_alternative<int>(value)) return std::get<int>(value);
+    if (std::holds_alternative<double>(value)) return std::get<double>(value);
+    return 0.0;
+}
+
+bool compare(const Value& field, CompareOp op, const Value& value) {
+    switch (op) {
+        case CMP_EQ: return field == value;
+        case CMP_NE: return field != value;
+        case CMP_LT: return field < value;
+        case CMP_LE: return field <= value;
+        case CMP_GT: return field > value;
+        case CMP_GE: return field >= value;
+    }
+    return false;
+}
+
+template <typename T>
+void appendKey(std::string& key, const T& value) {
+    key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendKey(std::string& key, const Value& value) {
+    appendKey(key, static_cast<uint8_t>(value.index()));
+    if (std::holds_alternative<int>(value)) {
+        appendKey(key, std::get<int>(value));
+    } else if (std::holds_alternative<double>(value)) {
+        appendKey(key, std::get<double>(value));
+    } else {
+        const std::string& s = std::get<std::string>(value);
+        appendKey(key, static_cast<uint64_t>(s.size()));
+        key += s;
+    }
+}
+
+void appendKey(std::string& key, const std::vector<Condition>& where) {
+    appendKey(key, static_cast<uint64_t>(where.size()));
+    for (const auto& cond : where) {
+        appendKey(key, static_cast<uint64_t>(cond.column));
+        appendKey(key, static_cast<uint8_t>(cond.op));
+        appendKey(key, cond.value);
+    }
+}
+
+}
+
+bool validConditions(const Schema& schema, const std::vector<Condition>& where) {
+    for (const auto& cond : where) {
+        if (cond.column >= schema.size() || cond.op > CMP_GE) return false;
+        if (cond.value.index() != static_cast<size_t>(schema[cond.column].second)) return false;
+    }
+    return true;
+}
+
+bool validQuery(const Schema& schema, const Query& query) {
+    if (!validConditions(schema, query.where)) return false;
+
+    for (size_t col : query.columns) {
+        if (col >= schema.size()) return false;
+    }
+    return true;
+}
+
+bool validAggregates(const Schema& schema, const std::vector<Aggregate>& aggregates) {
+    for (const auto& agg : aggregates) {
+        if (agg.op > AGG_AVG) return false;
+        if (agg.op == AGG_COUNT) continue;
+        if (agg.column >= schema.size()) return false;
+        if ((agg.op == AGG_SUM || agg.op == AGG_AVG) && schema[agg.column].second == STRING) return false;
+    }
+    return true;
+}
+
+bool matches(const std::vector<Condition>& where, const Row& row) {
+    for (const auto& cond : where) {
+        if (cond.column >= row.size() || !compare(row[cond.column], cond.op, cond.value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool mayMatch(const std::vector<Condition>& where, const std::vector<ColumnStats>& stats) {
+    for (const auto& cond : where) {
+        if (cond.column >= stats.size()) continue;
+
+        const ColumnStats& col = stats[cond.column];
+        if (!col.hasValue) return false;
+        if (col.min.index() != cond.value.index()) continue;
+
+        switch (cond.op) {
+            case CMP_EQ:
+                if (cond.value < col.min || col.max < cond.value) return false;
+                break;
+            case CMP_NE:
+                if (col.min == cond.value && col.max == cond.value) return false;
+                break;
+            case CMP_LT:
+                if (!(col.min < cond.value)) return false;
+                break;
+            case CMP_LE:
+                if (cond.value < col.min) return false;
+                break;
+            case CMP_GT:
+                if (!(cond.value < col.max)) return false;
+                break;
+            case CMP_GE:
+                if (col.max < cond.value) return false;
+                break;
+        }
+    }
+    return true;
+}
+
+Row project(const Row& row, const std::vector<size_t>& columns) {
+    if (columns.empty()) {
+        return row;
+    }
+
+    Row result;
+    result.reserve(columns.size());
+    for (size_t col : columns) {
+        result.push_back(row[col]);
+    }
+    return result;
+}
+
+Schema projectSchema(const Schema& schema, const std::vector<size_t>& columns) {
+    if (columns.empty()) {
+        return schema;
+    }
+
+    Schema result;
+    for (size_t col : columns) {
+        result.push_back(schema[col]);
+    }
+    return result;
+}
+
+// Non-finite values would poison the partials, so they are only counted
+void ExactSum::addDouble(double x, int sign) {
+    if (std::isnan(x)) {
+        nans += sign;
+        return;
+    }
+    if (std::isinf(x)) {
+        (x > 0 ? positiveInfs : negativeInfs) += sign;
+        return;
+    }
+
+    x *= sign;
+    size_t kept = 0;
+    for (size_t i = 0; i < partials.size(); i++) {
+        double y = partials[i];
+        if (std::abs(x) < std::abs(y)) std::swap(x, y);
+        double hi = x + y;
+        double lo = y - (hi - x);
+        if (lo != 0.0) partials[kept++] = lo;
+        x = hi;
+    }
+    partials.resize(kept);
+    partials.push_back(x);
+}
+
+void ExactSum::add(const Value& value) {
+    if (const int* v = std::get_if<int>(&value)) {
+        ints += *v;
+    } else {
+        addDouble(numeric(value), 1);
+    }
+}
+
+void ExactSum::remove(const Value& value) {
+    if (const int* v = std::get_if<int>(&value)) {
+        ints -= *v;
+    } else {
+        addDouble(numeric(value), -1);
+    }
+}
+
+void ExactSum::clear() {
+    ints = 0;
+    partials.clear();
+    nans = positiveInfs = negativeInfs = 0;
+}
+
+// Rounds the exact total once, half to even (as Python's math.fsum)
+double ExactSum::value() const {
+    if (nans > 0 || (positiveInfs > 0 && negativeInfs > 0)) return std::nan("");
+    if (positiveInfs > 0) return HUGE_VAL;
+    if (negativeInfs > 0) return -HUGE_VAL;
+
+    if (partials.empty()) return static_cast<double>(ints);
+
+    ExactSum total = *this;
+    if (ints != 0) {
+        // Split so each half converts to double exactly
+        int64_t high = ints / (int64_t(1) << 32) * (int64_t(1) << 32);
+        total.addDouble(static_cast<double>(high), 1);
+        total.addDouble(static_cast<double>(ints - high), 1);
+    }
+
+    const std::vector<double>& p = total.partials;
+    size_t n = p.size();
+    double hi = p[--n];
+    double lo = 0.0;
+    while (n > 0) {
+        double x = hi;
+        double y = p[--n];
+        hi = x + y;
+        lo = y - (hi - x);
+        if (lo != 0.0) break;
+    }
+    if (n > 0 && ((lo < 0 && p[n - 1] < 0) || (lo > 0 && p[n - 1] > 0))) {
+        double y = lo * 2;
+        double x = hi + y;
+        if (y == x - hi) hi = x;
+    }
+    return hi;
+}
+
+Aggregator::Aggregator(const std::vector<Aggregate>& aggregates)
+    : aggregates(aggregates), sums(aggregates.size()), extremes(aggregates.size()) {}
+
+void Aggregator::add(const Row& row) {
+    count++;
+
+    for (size_t i = 0; i < aggregates.size(); i++) {
+        const Aggregate& agg = aggregates[i];
+        if (agg.op == AGG_COUNT || agg.column >= row.size()) continue;
+
+        const Value& value = row[agg.column];
+        auto& extreme = extremes[i];
+        switch (agg.op) {
+            case AGG_SUM:
+            case AGG_AVG:
+                sums[i].add(value);
+                break;
+            case AGG_MIN:
+                if (!extreme.has_value() || value < *extreme) extreme = value;
+                break;
+            case AGG_MAX:
+                if (!extreme.has_value() || *extreme < value) extreme = value;
+                break;
+            case AGG_COUNT:
+                break;
+        }
+    }
+}
+
+AggregateResults Aggregator::results() const {
+    AggregateResults results(aggregates.size());
+
+    for (size_t i = 0; i < aggregates.size(); i++) {
+        switch (aggregates[i].op) {
+            case AGG_COUNT:
+                results[i] = static_cast<int>(count);
+                break;
+            case AGG_SUM:
+                if (count > 0) results[i] = sums[i].value();
+                break;
+            case AGG_AVG:
+                if (count > 0) results[i] = sums[i].value() / count;
+                break;
+            case AGG_MIN:
+            case AGG_MAX:
+                results[i] = extremes[i];
+                break;
+        }
+    }
+
+    return results;
+}
+
+std::string queryKey(const Query& query) {
+    std::string key = "S";
+    appendKey(key, query.where);
+    appendKey(key, static_cast<uint64_t>(query.columns.size()));
+    for (size_t col : query.columns) {
+        appendKey(key, static_cast<uint64_t>(col));
+    }
+    appendKey(key, static_cast<uint64_t>(query.limit));
+    return key;
+}
+
+std::string aggregateKey(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates) {
+    std::string key = "A";
+    appendKey(key, where);
+    appendKey(key, static_cast<uint64_t>(aggregates.size()));
+    for (const auto& agg : aggregates) {
+        appendKey(key, static_cast<uint8_t>(agg.op));
+        // COUNT ignores its column
+        appendKey(key, static_cast<uint64_t>(agg.op == AGG_COUNT ? 0 : agg.column));
+    }
+    return key;
+}
+
+AggregateView::AggregateView(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates)
+    : where(where), aggregates(aggregates), sums(aggregates.size()), values(aggregates.size()) {}
+
+const std::vector<Condition>& AggregateView::getWhere() const {
+    return where;
+}
+
+const std::vector<Aggregate>& AggregateView::getAggregates() const {
+    return aggregates;
+}
+
+void AggregateView::add(const Row& row) {
+    if (!matches(where, row)) return;
+    count++;
+
+    for (size_t i = 0; i < aggregates.size(); i++) {
+        const Aggregate& agg = aggregates[i];
+        if (agg.op == AGG_COUNT || agg.column >= row.size()) continue;
+
+        if (agg.op == AGG_MIN || agg.op == AGG_MAX) {
+            values[i].insert(row[agg.column]);
+        } else {
+            sums[i].add(row[agg.column]);
+        }
+    }
+}
+
+void AggregateView::remove(const Row& row) {
+    if (!matches(where, row) || count == 0) return;
+    count--;
+
+    for (size_t i = 0; i < aggregates.size(); i++) {
+        const Aggregate& agg = aggregates[i];
+        if (agg.op == AGG_COUNT || agg.column >= row.size()) continue;
+
+        if (agg.op == AGG_MIN || agg.op == AGG_MAX) {
+            auto it = values[i].find(row[agg.column]);
+            if (it != values[i].end()) values[i].erase(it);
+        } else {
+            sums[i].remove(row[agg.column]);
+        }
+    }
+}
+
+void AggregateView::clear() {
+    count = 0;
+    for (auto& sum : sums) {
+        sum.clear();
+    }
+    for (auto& set : values) {
+        set.clear();
+    }
+}
+
+AggregateResults AggregateView::results() const {
+    AggregateResults results(aggregates.size());
+
+    for (size_t i = 0; i < aggregates.size(); i++) {
+        switch (aggregates[i].op) {
+            case AGG_COUNT:
+                results[i] = static_cast<int>(count);
+                break;
+            case AGG_SUM:
+                if (count > 0) results[i] = sums[i].value();
+                break;
+            case AGG_AVG:
+                if (count > 0) results[i] = sums[i].value() / count;
+                break;
+            case AGG_MIN:
+                if (!values[i].empty()) results[i] = *values[i].begin();
+                break;
+            case AGG_MAX:
+                if (!values[i].empty()) results[i] = *values[i].rbegin();
+                break;
+        }
+    }
+
+    return results;
+}
@@ -0,0 +1,84 @@
+#include "ResultCache.hpp"
+
+ResultCache::ResultCache(size_t capacity) : capacity(capacity) {}
+
+ResultCache::Entry* ResultCache::find(const std::string& key, uint64_t version) {
+    auto it = index.find(key);
+    if (it == index.end() || it->second->version != version) {
+        stats.misses++;
+        return nullptr;
+    }
+
+    stats.hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return &entries.front();
+}
+
+ResultCache::Entry& ResultCache::store(const std::string& key, uint64_t version) {
+    auto it = index.find(key);
+    if (it != index.end()) {
+        entries.splice(entries.begin(), entries, it->second);
+    } else {
+        entries.push_front(Entry{key, version, {}, {}});
+        index[key] = entries.begin();
+
+        if (entries.size() > capacity) {
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+
+    Entry& entry = entries.front();
+    entry.version = version;
+    return entry;
+}
+
+std::optional<TableData> ResultCache::getRows(const std::string& key, uint64_t version) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry* entry = find(key, version);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    return entry->rows;
+}
+
+void ResultCache::putRows(const std::string& key, uint64_t version, const TableData& rows) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (capacity == 0) return;
+    store(key, version).rows = rows;
+}
+
+std::optional<AggregateResults> ResultCache::getValues(const std::string& key, uint64_t version) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry* entry = find(key, version);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    return entry->values;
+}
+
+void ResultCache::putValues(const std::string& key, uint64_t version, const AggregateResults& values) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (capacity == 0) return;
+    store(key, version).values = values;
+}
+
+void ResultCache::setCapacity(size_t entryCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = entryCount;
+    while (entries.size() > capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+}
+
+ResultCacheStats ResultCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -24,7 +24,59 @@ bool RowStore::validateRow(const Row &row) const {
     return true;
 }
 
+bool RowStore::rejectWrite() const {
+    if (read_only) {
+        std::cerr << "Warning: RowStore is read-only, write ignored\n";
+    }
+    return read_only;
+}
+
+void RowStore::setReadOnly(bool readOnly) {
+    read_only = readOnly;
+}
+
+bool RowStore::isReadOnly() const {
+    return read_only;
+}
+
+void RowStore::markDirty(size_t index) {
+    if (row_pages[index] != 0) {
+        dirty_pages.insert(row_pages[index]);
+    }
+}
+
+void RowStore::addToViews(const Row& row) {
+    for (auto& entry : views) {
+        entry.second.add(row);
+    }
+}
+
+void RowStore::removeFromViews(const Row& row) {
+    for (auto& entry : views) {
+        entry.second.remove(row);
+    }
+}
+
+void RowStore::rebuildViews() {
+    for (auto& entry : views) {
+        entry.second.clear();
+        for (const auto& row : table_data) {
+            entry.second.add(row);
+        }
+    }
+}
+
+void RowStore::retrack() {
+    if (!version_tracked) {
+        version_tracked = true;
+        rebuildViews();
+    }
+    version++;
+}
+
 TableData& RowStore::getData() {
+    placement_valid = false;
+    version_tracked = false;
     return table_data;
 }
 
@@ -33,11 +85,64 @@ const TableData& RowStore::getData() const {
 }
 
 void RowStore::loadData(const TableData& data) {
+    if (rejectWrite()) return;
+    table_data = data;
+    row_pages.assign(table_data.size(), 0);
+    dirty_pages.clear();
+    placement_valid = false;
+    version_tracked = false;
+    retrack();
+}
+
+void RowStore::loadData(const TableData& data, const std::vector<uint32_t>& rowPages) {
+    if (rejectWrite()) return;
     table_data = data;
+    row_pages = rowPages;
+    row_pages.resize(table_data.size(), 0);
+    dirty_pages.clear();
+    placement_valid = true;
+    pending_inserts = false;
+    version_tracked = false;
+    retrack();
+}
+
+const std::vector<uint32_t>& RowStore::getRowPages() const {
+    return row_pages;
+}
+
+const std::set<uint32_t>& RowStore::getDirtyPages() const {
+    return dirty_pages;
+}
+
+bool RowStore::hasValidPlacement() const {
+    return placement_valid;
+}
+
+bool RowStore::hasUnflushedChanges() const {
+    return !placement_valid || pending_inserts || !dirty_pages.empty();
+}
+
+void RowStore::markFlushed(const std::vector<uint32_t>& rowPages) {
+    row_pages = rowPages;
+    row_pages.resize(table_data.size(), 0);
+    dirty_pages.clear();
+    placement_valid = true;
+    pending_inserts = false;
+    
+    // Rows are unchanged by a flush unless mutable access left them untracked
+    if (!version_tracked) {
+        retrack();
+    }
 }
 
 void RowStore::clear() {
+    if (rejectWrite()) return;
     table_data.clear();
+    row_pages.clear();
+    dirty_pages.clear();
+    placement_valid = false;
+    version_tracked = false;
+    retrack();
 }
 
 void RowStore::printAll() const {
@@ -54,11 +159,15 @@ size_t RowStore::rowCount() const {
 }
 
 bool RowStore::insert(const Row& row) {
-    if (!validateRow(row)) {
+    if (rejectWrite() || !validateRow(row)) {
         return false;
     }
     
     table_data.push_back(row);
+    row_pages.push_back(0);
+    pending_inserts = true;
+    addToViews(row);
+    version++;
     return true;
 }
 
@@ -82,7 +191,7 @@ TableData RowStore::select(std::function<bool(const Row&)> predicate) const {
 }
 
 bool RowStore::update(size_t index, const Row& newRow) {
-    if (index >= table_data.size()) {
+    if (rejectWrite() || index >= table_data.size()) {
         return false;
     }
     
@@ -90,7 +199,11 @@ bool RowStore::update(size_t index, const Row& newRow) {
         return false;
     }
     
+    removeFromViews(table_data[index]);
     table_data[index] = newRow;
+    addToViews(newRow);
+    markDirty(index);
+    version++;
     return true;
 }
 
@@ -98,37 +211,132 @@ size_t RowStore::updateWhere(
     std::function<bool(const Row&)> predicate,
     std::function<Row(const Row&)> updateFunc)
 {
+    if (rejectWrite()) return 0;
     size_t updateCount = 0;
     
-    for (auto& row : table_data) {
+    for (size_t i = 0; i < table_data.size(); i++) {
+        auto& row = table_data[i];
         if (predicate(row)) {
             auto newRow = updateFunc(row);
             if (validateRow(newRow)) {
+                removeFromViews(row);
                 row = newRow;
+                addToViews(row);
+                markDirty(i);
                 updateCount++;
             }
         }
     }
     
+    if (updateCount > 0) {
+        version++;
+    }
     return updateCount;
 }
 
 bool RowStore::deleteRow(size_t index) {
-    if (index >= table_data.size()) {
+    if (rejectWrite() || index >= table_data.size()) {
         return false;
     }
     
+    markDirty(index);
+    removeFromViews(table_data[index]);
     table_data.erase(table_data.begin() + index);
+    row_pages.erase(row_pages.begin() + index);
+    version++;
     return true;
 }
 
 size_t RowStore::deleteWhere(std::function<bool(const Row&)> predicate) {
+    if (rejectWrite()) return 0;
     size_t initialSize = table_data.size();
+    size_t kept = 0;
+    
+    // Compact rows and their page numbers together
+    for (size_t i = 0; i < table_data.size(); i++) {
+        if (predicate(table_data[i])) {
+            markDirty(i);
+            removeFromViews(table_data[i]);
+            continue;
+        }
+        if (kept != i) {
+            table_data[kept] = std::move(table_data[i]);
+            row_pages[kept] = row_pages[i];
+        }
+        kept++;
+    }
     
-    table_data.erase(
-        std::remove_if(table_data.begin(), table_data.end(), predicate),
-        table_data.end()
-    );
+    table_data.resize(kept);
+    row_pages.resize(kept);
     
+    if (kept < initialSize) {
+        version++;
+    }
     return initialSize - table_data.size();
+}
+
+std::optional<uint64_t> RowStore::getVersion() const {
+    if (!version_tracked) {
+        return std::nullopt;
+    }
+    return version;
+}
+
+size_t RowStore::addView(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates) {
+    std::string key = aggregateKey(where, aggregates);
+    auto existing = view_ids.find(key);
+    if (existing != view_ids.end()) {
+        return existing->second;
+    }
+    
+    size_t id = next_view_id++;
+    AggregateView& view = views.emplace(id, AggregateView(where, aggregates)).first->second;
+    for (const auto& row : table_data) {
+        view.add(row);
+    }
+    view_ids[key] = id;
+    return id;
+}
+
+bool RowStore::dropView(size_t id) {
+    auto it = views.find(id);
+    if (it == views.end()) {
+        return false;
+    }
+    
+    view_ids.erase(aggregateKey(it->second.getWhere(), it->second.getAggregates()));
+    views.erase(it);
+    return true;
+}
+
+std::optional<size_t> RowStore::findView(
+    const std::vector<Condition>& where,
+    const std::vector<Aggregate>& aggregates) const
+{
+    if (views.empty()) {
+        return std::nullopt;
+    }
+    
+    auto it = view_ids.find(aggregateKey(where, aggregates));
+    if (it == view_ids.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<AggregateResults> RowStore::viewResults(size_t id) const {
+    auto it = views.find(id);
+    if (it == views.end()) {
+        return std::nullopt;
+    }
+    
+    if (version_tracked) {
+        return it->second.results();
+    }
+    
+    AggregateView fresh(it->second.getWhere(), it->second.getAggregates());
+    for (const auto& row : table_data) {
+        fresh.add(row);
+    }
+    return fresh.results();
 }
\ No newline at end of file
@@ -0,0 +1,556 @@
+#include "Server.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t READ_CHUNK = 64 * 1024;
+constexpr int MAX_EVENTS = 128;
+
+Response errorResponse(uint32_t id, const std::string& message) {
+    Response response;
+    response.id = id;
+    response.status = STATUS_ERROR;
+    response.error = message;
+    return response;
+}
+
+}
+
+Server::Server(const ServerOptions& options) : options(options) {}
+
+Server::~Server() {
+    stop();
+}
+
+bool Server::addTable(const std::string& name, std::unique_ptr<Table> table) {
+    if (running || table == nullptr || tables.count(name)) {
+        return false;
+    }
+
+    if (table->getEngine() == ROW_STORE) {
+        table->load();
+    }
+
+    auto slot = std::make_unique<TableSlot>();
+    slot->table = std::move(table);
+    tables[name] = std::move(slot);
+    return true;
+}
+
+uint16_t Server::getPort() const {
+    return port;
+}
+
+bool Server::openListener() {
+    if (!options.socketPath.empty()) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (options.socketPath.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Warning: Socket path too long: " << options.socketPath << "\n";
+            return false;
+        }
+        std::strncpy(addr.sun_path, options.socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        unlink(options.socketPath.c_str());
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::cerr << "Warning: Cannot bind " << options.socketPath << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(options.port);
+
+        int reuse = 1;
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd >= 0) {
+            setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        }
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::cerr << "Warning: Cannot bind port " << options.port << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+    }
+
+    if (listen(listenFd, SOMAXCONN) < 0) {
+        std::cerr << "Warning: listen failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool Server::start() {
+    if (running) {
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0 || !openListener()) {
+        stop();
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    stopping = false;
+    running = true;
+    for (size_t i = 0; i < options.workers; i++) {
+        workers.emplace_back(&Server::workerLoop, this);
+    }
+    loop = std::thread(&Server::eventLoop, this);
+    return true;
+}
+
+void Server::stop() {
+    if (running) {
+        running = false;
+        wake();
+        if (loop.joinable()) {
+            loop.join();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueSignal.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        runQueue.clear();
+        completed.clear();
+
+        for (auto& [fd, conn] : connections) {
+            close(fd);
+        }
+        connections.clear();
+
+        for (auto& [name, slot] : tables) {
+            std::unique_lock<std::shared_mutex> lock(slot->mutex);
+            slot->table->flush();
+        }
+    }
+
+    if (listenFd >= 0) {
+        close(listenFd);
+        if (!options.socketPath.empty()) {
+            unlink(options.socketPath.c_str());
+        }
+    }
+    if (epollFd >= 0) close(epollFd);
+    if (wakeFd >= 0) close(wakeFd);
+    listenFd = epollFd = wakeFd = -1;
+}
+
+void Server::wake() {
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        std::cerr << "Warning: Cannot wake event loop: " << std::strerror(errno) << "\n";
+    }
+}
+
+void Server::eventLoop() {
+    epoll_event events[MAX_EVENTS];
+
+    while (running) {
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Warning: epoll_wait failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == listenFd) {
+                accept();
+                continue;
+            }
+
+            if (fd == wakeFd) {
+                uint64_t count;
+                while (read(wakeFd, &count, sizeof(count)) > 0) {}
+
+                std::vector<ConnectionPtr> finished;
+                {
+                    std::lock_guard<std::mutex> lock(completedMutex);
+                    finished.swap(completed);
+                }
+                for (const auto& conn : finished) {
+                    if (conn->closed) {
+                        closeConnection(conn);
+                        continue;
+                    }
+                    writeOutput(conn);
+                    schedule(conn);
+                    if (conn->closed || drained(conn)) {
+                        closeConnection(conn);
+                    } else {
+                        updateEvents(conn);
+                    }
+                }
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            ConnectionPtr conn = it->second;
+
+            if (!conn->inputClosed && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                readInput(conn);
+            }
+            if (!conn->closed && (events[i].events & EPOLLOUT)) {
+                writeOutput(conn);
+            }
+
+            if (!conn->closed) {
+                schedule(conn);
+            }
+            if (conn->closed || drained(conn)) {
+                closeConnection(conn);
+            } else {
+                updateEvents(conn);
+            }
+        }
+    }
+}
+
+void Server::accept() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "Warning: accept failed: " << std::strerror(errno) << "\n";
+            }
+            return;
+        }
+
+        if (options.socketPath.empty()) {
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
+
+        auto conn = std::make_shared<Connection>();
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+
+        epoll_event ev{};
+        ev.events = conn->events;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        connections[fd] = conn;
+    }
+}
+
+void Server::readInput(const ConnectionPtr& conn) {
+    std::vector<char>& input = conn->input;
+
+    while (true) {
+        size_t used = input.size();
+        input.resize(used + READ_CHUNK);
+        ssize_t n = read(conn->fd, input.data() + used, READ_CHUNK);
+        input.resize(used + (n > 0 ? n : 0));
+
+        if (n > 0) continue;
+        // EOF only ends the requests; frames already read are still answered
+        if (n == 0) {
+            conn->inputClosed = true;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            conn->closed = true;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        break;
+    }
+
+    size_t offset = 0;
+    std::deque<std::vector<char>> frames;
+    while (true) {
+        size_t frameSize = 0;
+        FrameState state = nextFrame(input.data() + offset, input.size() - offset, frameSize);
+        if (state == FRAME_INCOMPLETE) break;
+        if (state == FRAME_INVALID) {
+            std::cerr << "Warning: Dropping connection after a malformed frame\n";
+            conn->closed = true;
+            break;
+        }
+
+        frames.emplace_back(input.begin() + offset, input.begin() + offset + frameSize);
+        offset += frameSize;
+    }
+    input.erase(input.begin(), input.begin() + offset);
+
+    if (!frames.empty()) {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        for (auto& frame : frames) {
+            conn->frames.push_back(std::move(frame));
+        }
+    }
+}
+
+void Server::writeOutput(const ConnectionPtr& conn) {
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    std::vector<char>& output = conn->output;
+
+    while (conn->outputOffset < output.size()) {
+        ssize_t n = send(conn->fd, output.data() + conn->outputOffset,
+                         output.size() - conn->outputOffset, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->outputOffset += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            conn->closed = true;
+        }
+        break;
+    }
+
+    if (conn->outputOffset == output.size()) {
+        output.clear();
+        conn->outputOffset = 0;
+    }
+}
+
+void Server::schedule(const ConnectionPtr& conn) {
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (conn->busy || conn->frames.empty()) {
+            return;
+        }
+        conn->busy = true;
+    }
+
+    if (options.workers == 0) {
+        process(*conn);
+        {
+            std::lock_guard<std::mutex> lock(conn->mutex);
+            conn->busy = false;
+        }
+        writeOutput(conn);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        runQueue.push_back(conn);
+    }
+    queueSignal.notify_one();
+}
+
+void Server::updateEvents(const ConnectionPtr& conn) {
+    uint32_t events = 0;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (!conn->inputClosed && conn->output.size() - conn->outputOffset <= options.maxPendingOutput) {
+            events |= EPOLLIN;
+        }
+        if (conn->outputOffset < conn->output.size()) {
+            events |= EPOLLOUT;
+        }
+    }
+
+    if (events != conn->events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = conn->fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->fd, &ev);
+        conn->events = events;
+    }
+}
+
+bool Server::drained(const ConnectionPtr& conn) {
+    if (!conn->inputClosed) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    return !conn->busy && conn->frames.empty() && conn->outputOffset == conn->output.size();
+}
+
+// A worker may still be running the connection's batch; the fd is only
+// closed once it has handed the connection back.
+void Server::closeConnection(const ConnectionPtr& conn) {
+    if (conn->fd < 0) {
+        return;
+    }
+
+    bool busy;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        busy = conn->busy;
+    }
+
+    if (conn->events != 0) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+        conn->events = 0;
+    }
+    if (busy) {
+        return;
+    }
+
+    connections.erase(conn->fd);
+    close(conn->fd);
+    conn->fd = -1;
+}
+
+void Server::workerLoop() {
+    while (true) {
+        ConnectionPtr conn;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueSignal.wait(lock, [this] { return stopping || !runQueue.empty(); });
+            if (stopping) return;
+            conn = std::move(runQueue.front());
+            runQueue.pop_front();
+        }
+
+        process(*conn);
+
+        {
+            std::lock_guard<std::mutex> lock(conn->mutex);
+            conn->busy = false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(conn);
+        }
+        wake();
+    }
+}
+
+void Server::process(Connection& conn) {
+    std::deque<std::vector<char>> batch;
+    {
+        std::lock_guard<std::mutex> lock(conn.mutex);
+        batch.swap(conn.frames);
+    }
+
+    std::vector<char> responses;
+    for (const auto& frame : batch) {
+        Request request;
+        Response response;
+        if (decodeRequest(frame.data(), frame.size(), request)) {
+            response = handle(request);
+        } else {
+            response = errorResponse(request.id, "malformed request");
+        }
+
+        // Every request must get a frame or later responses are misattributed
+        if (!encodeResponse(response, request.op, responses)) {
+            encodeResponse(errorResponse(request.id, "response cannot be encoded"), request.op, responses);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    conn.output.insert(conn.output.end(), responses.begin(), responses.end());
+}
+
+Response Server::handle(const Request& request) {
+    Response response;
+    response.id = request.id;
+
+    if (request.op == OP_PING) {
+        return response;
+    }
+
+    auto it = tables.find(request.table);
+    if (it == tables.end()) {
+        return errorResponse(request.id, "unknown table " + request.table);
+    }
+
+    TableSlot& slot = *it->second;
+    Table& table = *slot.table;
+    const Schema& schema = table.getSchema();
+
+    switch (request.op) {
+        case OP_SCHEMA:
+            response.schema = schema;
+            break;
+
+        case OP_INSERT: {
+            // LsmStore synchronizes itself; RowStore does not
+            std::unique_lock<std::shared_mutex> exclusive(slot.mutex, std::defer_lock);
+            std::shared_lock<std::shared_mutex> shared(slot.mutex, std::defer_lock);
+            if (table.getEngine() == LSM) {
+                shared.lock();
+            } else {
+                exclusive.lock();
+            }
+
+            for (const auto& row : request.rows) {
+                if (table.insert(row)) {
+                    response.count++;
+                }
+            }
+            break;
+        }
+
+        case OP_GET: {
+            Query query;
+            query.where.push_back({table.getKeyColumn(), CMP_EQ, request.key});
+            if (!validQuery(schema, query)) {
+                return errorResponse(request.id, "key does not match the key column type");
+            }
+
+            std::shared_lock<std::shared_mutex> lock(slot.mutex);
+            response.rows = table.select(query);
+            break;
+        }
+
+        case OP_SELECT: {
+            if (!validQuery(schema, request.query)) {
+                return errorResponse(request.id, "invalid query");
+            }
+
+            std::shared_lock<std::shared_mutex> lock(slot.mutex);
+            response.rows = table.select(request.query);
+            break;
+        }
+
+        case OP_AGGREGATE: {
+            if (!validConditions(schema, request.query.where) || !validAggregates(schema, request.aggregates)) {
+                return errorResponse(request.id, "invalid aggregate");
+            }
+
+            std::shared_lock<std::shared_mutex> lock(slot.mutex);
+            response.values = table.aggregate(request.query.where, request.aggregates);
+            break;
+        }
+
+        case OP_FLUSH: {
+            std::unique_lock<std::shared_mutex> lock(slot.mutex);
+            table.flush();
+            break;
+        }
+
+        default:
+            return errorResponse(request.id, "unknown opcode");
+    }
+
+    return response;
+}
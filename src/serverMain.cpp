@@ -0,0 +1,73 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <pthread.h>
+#include "Catalog.hpp"
+#include "Server.hpp"
+
+void usage() {
+    std::cerr << "Usage: minidb-server <catalog> [--socket PATH | --port N] [--workers N]\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    ServerOptions options;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        if (arg == "--socket") {
+            options.socketPath = argv[++i];
+        } else if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--workers") {
+            options.workers = static_cast<size_t>(std::atoi(argv[++i]));
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    // Blocked before any thread starts so only sigwait below sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    Catalog catalog(argv[1]);
+    Server server(options);
+
+    for (const auto& name : catalog.tableNames()) {
+        auto table = catalog.openTable(name);
+        if (table == nullptr || !server.addTable(name, std::move(table))) {
+            std::cerr << "Warning: Cannot open table " << name << "\n";
+            continue;
+        }
+        std::cout << "Loaded table " << name << "\n";
+    }
+
+    if (!server.start()) {
+        return 1;
+    }
+
+    if (options.socketPath.empty()) {
+        std::cout << "Listening on 127.0.0.1:" << server.getPort() << "\n";
+    } else {
+        std::cout << "Listening on " << options.socketPath << "\n";
+    }
+
+    int received = 0;
+    sigwait(&signals, &received);
+
+    std::cout << "Shutting down, flushing tables\n";
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,426 @@
+#include "Sorter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <unistd.h>
+
+namespace {
+
+// Numbers every external sort in the process; with the pid it keeps the run
+// files of concurrent orderBy calls on one table (or one prefix) apart
+std::atomic<uint64_t> nextSortId{0};
+
+void appendBigEndian(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = bytes; i > 0; i--) {
+        out.push_back(static_cast<char>((value >> ((i - 1) * 8)) & 0xFF));
+    }
+}
+
+bool entryLess(const std::string& a, size_t seqA, const std::string& b, size_t seqB) {
+    int cmp = a.compare(b);
+    return cmp < 0 || (cmp == 0 && seqA < seqB);
+}
+
+// Same field layout as FileManager::serializeRow but without its PAGE_SIZE cap
+// on strings: a spilled row only has to survive the merge, not fit a page.
+void encodeSpillRow(const Row& row, std::string& out) {
+    out.clear();
+    for (const auto& field : row) {
+        if (const int* v = std::get_if<int>(&field)) {
+            out.append(reinterpret_cast<const char*>(v), sizeof(int));
+        } else if (const double* v = std::get_if<double>(&field)) {
+            out.append(reinterpret_cast<const char*>(v), sizeof(double));
+        } else {
+            const std::string& str = std::get<std::string>(field);
+            uint32_t len = str.size();
+            out.append(reinterpret_cast<const char*>(&len), sizeof(len));
+            out.append(str);
+        }
+    }
+}
+
+bool decodeSpillRow(const std::string& data, const Schema& schema, Row& row) {
+    row.clear();
+    size_t offset = 0;
+
+    for (const auto& col : schema) {
+        switch (col.second) {
+            case INT: {
+                int value;
+                if (offset + sizeof(int) > data.size()) return false;
+                std::memcpy(&value, data.data() + offset, sizeof(int));
+                offset += sizeof(int);
+                row.push_back(value);
+                break;
+            }
+            case DOUBLE: {
+                double value;
+                if (offset + sizeof(double) > data.size()) return false;
+                std::memcpy(&value, data.data() + offset, sizeof(double));
+                offset += sizeof(double);
+                row.push_back(value);
+                break;
+            }
+            case STRING: {
+                uint32_t len;
+                if (offset + sizeof(uint32_t) > data.size()) return false;
+                std::memcpy(&len, data.data() + offset, sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                if (len > data.size() - offset) return false;
+                row.push_back(data.substr(offset, len));
+                offset += len;
+                break;
+            }
+        }
+    }
+
+    return offset == data.size();
+}
+
+bool writeRecord(std::ofstream& out, const std::string& key, uint64_t seq, const std::string& row) {
+    uint32_t keyLen = key.size();
+    uint32_t rowLen = row.size();
+    out.write(reinterpret_cast<const char*>(&keyLen), sizeof(keyLen));
+    out.write(key.data(), keyLen);
+    out.write(reinterpret_cast<const char*>(&seq), sizeof(seq));
+    out.write(reinterpret_cast<const char*>(&rowLen), sizeof(rowLen));
+    out.write(row.data(), rowLen);
+    return out.good();
+}
+
+bool readRecord(std::ifstream& in, std::string& key, uint64_t& seq, std::string& row) {
+    uint32_t keyLen = 0;
+    if (!in.read(reinterpret_cast<char*>(&keyLen), sizeof(keyLen))) return false;
+    key.resize(keyLen);
+    if (!in.read(key.data(), keyLen)) return false;
+    if (!in.read(reinterpret_cast<char*>(&seq), sizeof(seq))) return false;
+
+    uint32_t rowLen = 0;
+    if (!in.read(reinterpret_cast<char*>(&rowLen), sizeof(rowLen))) return false;
+    row.resize(rowLen);
+    return static_cast<bool>(in.read(row.data(), rowLen));
+}
+
+}
+
+Sorter::Sorter(
+    const Schema& schema,
+    const OrderBy& orderBy,
+    size_t memoryBudget,
+    const std::string& spillPrefix)
+    : schema(schema), orderBy(orderBy), memoryBudget(memoryBudget), spillPrefix(spillPrefix) {}
+
+size_t Sorter::rowFootprint(const Row& row) {
+    size_t bytes = 0;
+
+    for (const auto& field : row) {
+        if (std::holds_alternative<int>(field)) {
+            bytes += sizeof(int);
+        } else if (std::holds_alternative<double>(field)) {
+            bytes += sizeof(double);
+        } else {
+            bytes += sizeof(uint32_t) + std::get<std::string>(field).size();
+        }
+    }
+
+    return bytes;
+}
+
+bool Sorter::validKeys() const {
+    if (orderBy.empty()) return false;
+
+    for (const auto& key : orderBy) {
+        if (key.column >= schema.size()) return false;
+    }
+
+    return true;
+}
+
+// Keys are built so that memcmp order equals the requested row order:
+// integers and doubles become order-preserving big-endian unsigned values,
+// strings escape 0x00 and end with a terminator so shorter prefixes sort
+// first, and descending columns have their bytes inverted.
+void Sorter::encodeKey(const Row& row, std::string& key) const {
+    key.clear();
+
+    for (const auto& sortKey : orderBy) {
+        size_t start = key.size();
+        const auto& field = row[sortKey.column];
+
+        switch (schema[sortKey.column].second) {
+            case INT: {
+                const int* value = std::get_if<int>(&field);
+                uint32_t bits = static_cast<uint32_t>(value ? *value : 0) ^ 0x80000000u;
+                appendBigEndian(key, bits, sizeof(uint32_t));
+                break;
+            }
+            case DOUBLE: {
+                const double* value = std::get_if<double>(&field);
+                double d = value ? *value : 0.0;
+                // -0.0 == 0.0, so both must encode alike to keep the sort stable
+                if (d == 0.0) d = 0.0;
+                uint64_t bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                bits = (bits & 0x8000000000000000ull) ? ~bits : bits ^ 0x8000000000000000ull;
+                appendBigEndian(key, bits, sizeof(uint64_t));
+                break;
+            }
+            case STRING: {
+                const std::string* value = std::get_if<std::string>(&field);
+                if (value) {
+                    for (char c : *value) {
+                        key.push_back(c);
+                        if (c == '\0') key.push_back('\xFF');
+                    }
+                }
+                key.push_back('\0');
+                key.push_back('\x01');
+                break;
+            }
+        }
+
+        if (sortKey.order == DESCENDING) {
+            for (size_t i = start; i < key.size(); i++) {
+                key[i] = static_cast<char>(~key[i]);
+            }
+        }
+    }
+}
+
+void Sorter::sortInMemory(const TableData& rows, size_t limit, const RowSink& emit) {
+    std::vector<Entry> entries(rows.size());
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        encodeKey(rows[i], entries[i].key);
+        entries[i].seq = i;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return entryLess(a.key, a.seq, b.key, b.seq);
+    });
+
+    size_t count = (limit > 0) ? std::min(limit, entries.size()) : entries.size();
+    for (size_t i = 0; i < count; i++) {
+        emit(rows[entries[i].seq]);
+    }
+}
+
+// Keeps the best `limit` keys in a max-heap so the largest is evicted first;
+// only O(limit) keys are alive at a time.
+void Sorter::topK(const TableData& rows, size_t limit, const RowSink& emit) {
+    auto heapLess = [](const Entry& a, const Entry& b) {
+        return entryLess(a.key, a.seq, b.key, b.seq);
+    };
+
+    std::vector<Entry> heap;
+    heap.reserve(limit);
+    Entry candidate;
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        encodeKey(rows[i], candidate.key);
+        candidate.seq = i;
+
+        if (heap.size() < limit) {
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end(), heapLess);
+        } else if (heapLess(candidate, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), heapLess);
+            heap.back() = candidate;
+            std::push_heap(heap.begin(), heap.end(), heapLess);
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), heapLess);
+
+    for (const auto& entry : heap) {
+        emit(rows[entry.seq]);
+    }
+}
+
+size_t Sorter::footprint(const Buffered& entry) {
+    return sizeof(Buffered) + entry.key.size() + rowFootprint(entry.row);
+}
+
+bool Sorter::spillRun(const std::vector<Buffered>& run, const std::string& path) {
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    std::string buffer;
+
+    for (const auto& entry : run) {
+        encodeSpillRow(entry.row, buffer);
+        if (!writeRecord(out, entry.key, entry.seq, buffer)) return false;
+    }
+
+    return true;
+}
+
+TableData Sorter::sort(const TableData& rows, size_t limit) {
+    TableData result;
+    sort(rows, limit, [&result](const Row& row) { result.push_back(row); });
+    return result;
+}
+
+bool Sorter::sort(const TableData& rows, size_t limit, const RowSink& emit) {
+    if (!validKeys()) {
+        std::cerr << "Warning: Invalid ORDER BY column\n";
+        return false;
+    }
+
+    if (limit > 0 && limit < rows.size()) {
+        size_t totalBytes = 0;
+        for (const auto& row : rows) {
+            totalBytes += sizeof(Entry) + rowFootprint(row);
+        }
+        size_t heapBytes = totalBytes / rows.size() * limit;
+        if (heapBytes <= memoryBudget) {
+            topK(rows, limit, emit);
+            return true;
+        }
+    }
+
+    sortInMemory(rows, limit, emit);
+    return true;
+}
+
+// Buffers rows up to the memory budget. A full buffer is sorted and, with a
+// limit, cut to its first `limit` rows; if that still fills half the budget
+// it is spilled as a run. The runs and the last buffer are then k-way merged
+// on (key, seq), so the sort is stable whichever run a row landed in.
+bool Sorter::sort(const RowSource& source, size_t limit, const RowSink& emit) {
+    if (!validKeys()) {
+        std::cerr << "Warning: Invalid ORDER BY column\n";
+        return false;
+    }
+
+    auto byKey = [](const Buffered& a, const Buffered& b) {
+        return entryLess(a.key, a.seq, b.key, b.seq);
+    };
+
+    std::vector<Buffered> buffer;
+    size_t bufferBytes = 0;
+    size_t compactAt = memoryBudget;
+    uint64_t seq = 0;
+    bool canSpill = true;
+    std::vector<std::string> runPaths;
+    std::string runPrefix = spillPrefix + ".sortrun." + std::to_string(getpid()) + "." +
+                            std::to_string(nextSortId++) + ".";
+
+    auto compact = [&]() {
+        std::sort(buffer.begin(), buffer.end(), byKey);
+        if (limit > 0 && buffer.size() > limit) {
+            buffer.resize(limit);
+            bufferBytes = 0;
+            for (const auto& entry : buffer) {
+                bufferBytes += footprint(entry);
+            }
+        }
+
+        if (canSpill && bufferBytes >= memoryBudget / 2) {
+            std::string path = runPrefix + std::to_string(runPaths.size());
+            if (spillRun(buffer, path)) {
+                runPaths.push_back(path);
+                buffer.clear();
+                bufferBytes = 0;
+            } else {
+                std::cerr << "Warning: Failed to spill sort run, sorting in memory\n";
+                std::remove(path.c_str());
+                canSpill = false;
+            }
+        }
+
+        // Kept rows (pruned or unspillable) must not trigger a sort per row
+        compactAt = std::max(memoryBudget, 2 * bufferBytes);
+    };
+
+    source([&](const Row& row) {
+        Buffered entry;
+        encodeKey(row, entry.key);
+        entry.seq = seq++;
+        entry.row = row;
+        bufferBytes += footprint(entry);
+        buffer.push_back(std::move(entry));
+
+        if (bufferBytes >= compactAt) {
+            compact();
+        }
+    });
+
+    std::sort(buffer.begin(), buffer.end(), byKey);
+
+    if (runPaths.empty()) {
+        size_t count = (limit > 0) ? std::min(limit, buffer.size()) : buffer.size();
+        for (size_t i = 0; i < count; i++) {
+            emit(buffer[i].row);
+        }
+        return true;
+    }
+
+    // Runs on disk, plus the last buffer as run `memoryRun` read in place
+    struct Head {
+        std::string key;
+        uint64_t seq;
+        std::string row;
+        size_t run;
+        size_t index;
+    };
+
+    auto headGreater = [](const Head& a, const Head& b) {
+        return entryLess(b.key, b.seq, a.key, a.seq);
+    };
+
+    size_t memoryRun = runPaths.size();
+    size_t memoryPos = 0;
+    std::vector<std::ifstream> inputs;
+    std::priority_queue<Head, std::vector<Head>, decltype(headGreater)> heads(headGreater);
+
+    auto pushNext = [&](Head head) {
+        if (head.run == memoryRun) {
+            if (memoryPos == buffer.size()) return;
+            head.index = memoryPos++;
+            head.key = std::move(buffer[head.index].key);
+            head.seq = buffer[head.index].seq;
+        } else if (!readRecord(inputs[head.run], head.key, head.seq, head.row)) {
+            return;
+        }
+        heads.push(std::move(head));
+    };
+
+    for (size_t r = 0; r < runPaths.size(); r++) {
+        inputs.emplace_back(runPaths[r], std::ios::in | std::ios::binary);
+    }
+    for (size_t r = 0; r <= memoryRun; r++) {
+        pushNext(Head{"", 0, "", r, 0});
+    }
+
+    size_t emitted = 0;
+    Row row;
+
+    while (!heads.empty() && (limit == 0 || emitted < limit)) {
+        Head head = heads.top();
+        heads.pop();
+
+        if (head.run == memoryRun) {
+            emit(buffer[head.index].row);
+            emitted++;
+        } else if (decodeSpillRow(head.row, schema, row)) {
+            emit(row);
+            emitted++;
+        } else {
+            std::cerr << "Warning: Corrupt sort run record, skipping\n";
+        }
+
+        pushNext(std::move(head));
+    }
+
+    inputs.clear();
+    for (const auto& path : runPaths) {
+        std::remove(path.c_str());
+    }
+
+    return true;
+}
@@ -1,7 +1,36 @@
 #include "Table.hpp"
+#include <chrono>
+#include <iostream>
 
 Table::Table(const std::string& name, std::ios::openmode mode, const Schema& schema)
-    : filename(name), file(name, mode), schema(schema), rowStore(schema) {}
+    : filename(name), file(name, mode), schema(schema), rowStore(schema), fileManager(name) {
+    openMetadata(mode);
+
+    if (!metadata.schema.empty() && metadata.schema != schema) {
+        std::cerr << "Warning: Schema of " << filename << " differs from the file header\n";
+    }
+    metadata.schema = schema;
+}
+
+Table::Table(const std::string& name, std::ios::openmode mode)
+    : filename(name), file(name, mode), rowStore(Schema()), fileManager(name) {
+    openMetadata(mode);
+
+    if (metadata.schema.empty()) {
+        std::cerr << "Warning: " << filename << " has no schema in its header\n";
+    }
+    schema = metadata.schema;
+    rowStore = RowStore(schema);
+}
+
+Table::Table(const std::string& name, std::ios::openmode mode, const Schema& schema, const LsmOptions& options)
+    : filename(name), schema(schema), rowStore(schema),
+      lsm(std::make_unique<LsmStore>(name, mode, schema, options)) {
+    metadata.schema = schema;
+    // Rows live in the LSM store; nothing written here would be persisted
+    rowStore.setReadOnly(true);
+    loaded = true;
+}
 
 Table::~Table() {
     if (file.is_open()) {
@@ -9,20 +38,500 @@ Table::~Table() {
     }
 }
 
+void Table::openMetadata(std::ios::openmode mode) {
+    // Nothing on disk yet: the empty RowStore already is the whole table
+    loaded = (mode & std::ios::trunc) || !fileManager.readMetadata(file, metadata);
+}
+
 void Table::load() {
+    if (lsm) {
+        return;
+    }
+
     TableData tempData;
-    fileManager.read(file, schema, tempData);
-    rowStore.loadData(tempData);
+    std::vector<uint32_t> rowPages;
+    fileManager.read(file, schema, tempData, metadata, &rowPages);
+    metadata.schema = schema;
+    rowStore.loadData(tempData, rowPages);
+    loaded = true;
+    resultCache.clear();
 }
 
 void Table::flush() {
-    fileManager.write(file, rowStore.getData());
+    if (lsm) {
+        lsm->flush();
+        return;
+    }
+
+    // Every mutation path loads first, so an unloaded table has nothing to
+    // write; a full write of its empty RowStore would drop the rows on disk
+    if (!loaded) {
+        return;
+    }
+
+    const RowStore& rows = rowStore;
+    std::vector<uint32_t> rowPages = rows.getRowPages();
+
+    // Tracked changes only touch dirty pages; anything else (or a flush that
+    // is mostly new rows, or an incremental write that could not allocate)
+    // rewrites the file
+    bool incremental = rows.hasValidPlacement() && fileManager.preferIncremental(metadata, rowPages);
+    if (!incremental || !fileManager.writeIncremental(file, schema, rows.getData(), rowPages, rows.getDirtyPages(), metadata)) {
+        fileManager.write(file, schema, rows.getData(), metadata, &rowPages);
+    }
+
+    rowStore.markFlushed(rowPages);
+    resultCache.clear();
+}
+
+bool Table::isLoaded() const {
+    return loaded;
 }
 
 RowStore& Table::getRowStore() {
+    if (lsm) {
+        std::cerr << "Warning: " << filename << " uses the LSM engine; its RowStore is empty and read-only\n";
+    } else if (!loaded) {
+        // Callers may mutate through the reference, so it must hold the table
+        load();
+    }
     return rowStore;
 }
 
+StorageEngine Table::getEngine() const {
+    return lsm ? LSM : ROW_STORE;
+}
+
+LsmStore* Table::getLsmStore() {
+    return lsm.get();
+}
+
+bool Table::insert(const Row& row) {
+    if (lsm) {
+        return lsm->put(row);
+    }
+    if (!loaded) {
+        load();
+    }
+    return rowStore.insert(row);
+}
+
+size_t Table::getKeyColumn() const {
+    if (lsm) {
+        return lsm->getKeyColumn();
+    }
+    return metadata.bloom.enabled ? metadata.bloom.keyColumn : 0;
+}
+
 const Schema& Table::getSchema() const {
     return schema;
-}
\ No newline at end of file
+}
+
+const TableMetadata& Table::getMetadata() const {
+    return metadata;
+}
+
+size_t Table::rowCount() const {
+    if (lsm) {
+        return lsm->rowCount();
+    }
+    return loaded ? rowStore.rowCount() : metadata.rowCount;
+}
+
+TableData Table::selectRange(size_t column, const Value& low, const Value& high) {
+    auto inRange = [&](const Row& row) {
+        return column < row.size() && !(row[column] < low) && !(high < row[column]);
+    };
+
+    if (column >= schema.size()) {
+        return {};
+    }
+
+    if (lsm) {
+        TableData result;
+        for (auto& row : lsm->scan()) {
+            if (inRange(row)) {
+                result.push_back(std::move(row));
+            }
+        }
+        return result;
+    }
+
+    if (loaded) {
+        return rowStore.select(inRange);
+    }
+
+    TableData result;
+    bool hasDirectory = metadata.pages.size() == metadata.pageCount;
+
+    for (uint32_t pageNum = 1; pageNum <= metadata.pageCount; pageNum++) {
+        if (hasDirectory && !statsOverlap(metadata.pages[pageNum - 1].stats[column], low, high)) {
+            continue;
+        }
+
+        TableData pageRows;
+        if (!fileManager.readPageRows(file, schema, metadata, pageNum, pageRows)) {
+            std::cerr << "Warning: Failed to read page " << pageNum << "\n";
+            continue;
+        }
+
+        for (auto& row : pageRows) {
+            if (inRange(row)) {
+                result.push_back(std::move(row));
+            }
+        }
+    }
+
+    return result;
+}
+
+void Table::scanMatching(const std::vector<Condition>& where, const std::function<bool(const Row&)>& visit) {
+    const Condition* keyEquals = nullptr;
+    for (const auto& cond : where) {
+        if (cond.op == CMP_EQ && cond.column == getKeyColumn()) {
+            keyEquals = &cond;
+        }
+    }
+
+    if (lsm) {
+        if (keyEquals != nullptr) {
+            auto row = lsm->get(keyEquals->value);
+            if (row.has_value() && matches(where, *row)) {
+                visit(*row);
+            }
+            return;
+        }
+
+        lsm->scan([&](const Row& row) {
+            return !matches(where, row) || visit(row);
+        });
+        return;
+    }
+
+    if (loaded) {
+        const RowStore& rows = rowStore;
+        for (const auto& row : rows.getData()) {
+            if (matches(where, row) && !visit(row)) return;
+        }
+        return;
+    }
+
+    bool hasDirectory = metadata.pages.size() == metadata.pageCount;
+    bool useBloom = keyEquals != nullptr && filtersCurrent();
+    uint64_t hash = useBloom ? hashValue(keyEquals->value) : 0;
+
+    for (uint32_t pageNum = 1; pageNum <= metadata.pageCount; pageNum++) {
+        if (hasDirectory && !mayMatch(where, metadata.pages[pageNum - 1].stats)) continue;
+        if (useBloom && !metadata.bloom.pages[pageNum - 1].mayContain(hash)) continue;
+
+        TableData pageRows;
+        if (!fileManager.readPageRows(file, schema, metadata, pageNum, pageRows)) {
+            std::cerr << "Warning: Failed to read page " << pageNum << "\n";
+            continue;
+        }
+
+        for (auto& row : pageRows) {
+            if (matches(where, row) && !visit(row)) return;
+        }
+    }
+}
+
+TableData Table::select(const Query& query) {
+    if (!validQuery(schema, query)) {
+        return {};
+    }
+
+    std::optional<uint64_t> version = cacheVersion();
+    std::string key;
+    if (version.has_value()) {
+        key = queryKey(query);
+        if (auto cached = resultCache.getRows(key, *version)) {
+            return std::move(*cached);
+        }
+    }
+
+    TableData result;
+    scanMatching(query.where, [&](const Row& row) {
+        result.push_back(project(row, query.columns));
+        return query.limit == 0 || result.size() < query.limit;
+    });
+
+    if (version.has_value()) {
+        resultCache.putRows(key, *version, result);
+    }
+    return result;
+}
+
+AggregateResults Table::aggregate(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates) {
+    if (!validConditions(schema, where) || !validAggregates(schema, aggregates)) {
+        return {};
+    }
+
+    if (!lsm && loaded) {
+        if (auto view = rowStore.findView(where, aggregates)) {
+            return *rowStore.viewResults(*view);
+        }
+    }
+
+    std::optional<uint64_t> version = cacheVersion();
+    std::string key;
+    if (version.has_value()) {
+        key = aggregateKey(where, aggregates);
+        if (auto cached = resultCache.getValues(key, *version)) {
+            return std::move(*cached);
+        }
+    }
+
+    Aggregator aggregator(aggregates);
+    scanMatching(where, [&](const Row& row) {
+        aggregator.add(row);
+        return true;
+    });
+    AggregateResults results = aggregator.results();
+
+    if (version.has_value()) {
+        resultCache.putValues(key, *version, results);
+    }
+    return results;
+}
+
+std::optional<size_t> Table::createView(const std::vector<Condition>& where, const std::vector<Aggregate>& aggregates) {
+    if (lsm || !validConditions(schema, where) || !validAggregates(schema, aggregates)) {
+        return std::nullopt;
+    }
+
+    if (!loaded) {
+        load();
+    }
+    return rowStore.addView(where, aggregates);
+}
+
+bool Table::dropView(size_t id) {
+    return !lsm && rowStore.dropView(id);
+}
+
+std::optional<AggregateResults> Table::viewResults(size_t id) const {
+    if (lsm) {
+        return std::nullopt;
+    }
+    return rowStore.viewResults(id);
+}
+
+std::optional<uint64_t> Table::cacheVersion() const {
+    // LSM writes run concurrently with reads and carry no version
+    if (lsm) {
+        return std::nullopt;
+    }
+    return rowStore.getVersion();
+}
+
+void Table::setResultCacheSize(size_t entries) {
+    resultCache.setCapacity(entries);
+}
+
+ResultCacheStats Table::getResultCacheStats() const {
+    return resultCache.getStats();
+}
+
+bool Table::enableBloomFilter(size_t column, uint32_t bitsPerKey) {
+    // LSM runs always carry filters on the store's key column
+    if (lsm) {
+        return column == lsm->getKeyColumn();
+    }
+
+    if (column >= schema.size() || bitsPerKey == 0) {
+        return false;
+    }
+
+    BloomIndex& bloom = metadata.bloom;
+    if (bloom.enabled && bloom.keyColumn == column && bloom.bitsPerKey == bitsPerKey) {
+        return true;
+    }
+
+    // Dropping the old filters makes the next flush rebuild them for every page
+    bloom = BloomIndex();
+    bloom.enabled = true;
+    bloom.keyColumn = column;
+    bloom.bitsPerKey = bitsPerKey;
+    return true;
+}
+
+bool Table::filtersCurrent() const {
+    const BloomIndex& bloom = metadata.bloom;
+    return bloom.enabled &&
+           bloom.pages.size() == metadata.pageCount &&
+           (!loaded || !rowStore.hasUnflushedChanges());
+}
+
+bool Table::probeTableFilter(uint64_t hash) {
+    auto start = std::chrono::steady_clock::now();
+    bool maybe = metadata.bloom.table.mayContain(hash);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    bloomStats.probes++;
+    bloomStats.probeNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    if (!maybe) {
+        bloomStats.negatives++;
+    }
+
+    return maybe;
+}
+
+bool Table::mayContain(const Value& key) {
+    if (lsm) {
+        return lsm->get(key).has_value();
+    }
+
+    if (!filtersCurrent()) {
+        return true;
+    }
+
+    return probeTableFilter(hashValue(key));
+}
+
+TableData Table::findByKey(const Value& key) {
+    if (lsm) {
+        auto row = lsm->get(key);
+        if (!row.has_value()) {
+            return {};
+        }
+        return {*row};
+    }
+
+    if (!metadata.bloom.enabled) {
+        std::cerr << "Warning: findByKey needs a Bloom filter key column\n";
+        return {};
+    }
+
+    size_t column = metadata.bloom.keyColumn;
+    auto matches = [&](const Row& row) {
+        return column < row.size() && row[column] == key;
+    };
+
+    if (!filtersCurrent()) {
+        if (loaded) {
+            return rowStore.select(matches);
+        }
+        return selectRange(column, key, key);
+    }
+
+    uint64_t hash = hashValue(key);
+    if (!probeTableFilter(hash)) {
+        return {};
+    }
+
+    TableData result;
+
+    if (loaded) {
+        result = rowStore.select(matches);
+    } else {
+        for (uint32_t pageNum = 1; pageNum <= metadata.pageCount; pageNum++) {
+            if (!metadata.bloom.pages[pageNum - 1].mayContain(hash)) continue;
+
+            TableData pageRows;
+            if (!fileManager.readPageRows(file, schema, metadata, pageNum, pageRows)) {
+                std::cerr << "Warning: Failed to read page " << pageNum << "\n";
+                continue;
+            }
+
+            for (auto& row : pageRows) {
+                if (matches(row)) {
+                    result.push_back(std::move(row));
+                }
+            }
+        }
+    }
+
+    if (result.empty()) {
+        bloomStats.falsePositives++;
+    }
+
+    return result;
+}
+
+const BloomStats& Table::getBloomStats() const {
+    return bloomStats;
+}
+
+void Table::printStats() const {
+    if (lsm) {
+        const LsmStats& stats = lsm->getStats();
+        // Counting live rows would merge every run; stored entries need no I/O
+        std::cout << filename << ": " << lsm->entryCount() << " entries (LSM), runs per level:";
+        for (size_t runs : lsm->levelSizes()) {
+            std::cout << " " << runs;
+        }
+        std::cout << "\n  flushes " << stats.flushes << ", compactions " << stats.compactions
+                  << ", run probes " << stats.runProbes << ", bloom skips " << stats.bloomSkips
+                  << ", fence skips " << stats.fenceSkips << ", page reads " << stats.pageReads << "\n";
+        return;
+    }
+
+    std::cout << filename << ": " << rowCount() << " rows, "
+              << metadata.pageCount << " pages (format v" << metadata.version << ")\n";
+
+    for (size_t i = 0; i < schema.size() && i < metadata.stats.size(); i++) {
+        const ColumnStats& stats = metadata.stats[i];
+        std::cout << "  " << schema[i].first << ": ";
+        if (stats.hasValue) {
+            std::visit([](auto&& val) { std::cout << "min " << val; }, stats.min);
+            std::visit([](auto&& val) { std::cout << ", max " << val; }, stats.max);
+        } else {
+            std::cout << "no values";
+        }
+        std::cout << "\n";
+    }
+
+    const BloomIndex& bloom = metadata.bloom;
+    if (!bloom.enabled) {
+        return;
+    }
+
+    size_t pageBytes = 0;
+    for (const auto& filter : bloom.pages) {
+        pageBytes += filter.sizeInBytes();
+    }
+
+    uint64_t absent = bloomStats.negatives + bloomStats.falsePositives;
+    std::cout << "  bloom(" << schema[bloom.keyColumn].first << "): "
+              << bloom.table.size() << " keys, "
+              << bloom.table.sizeInBytes() << " table bytes, "
+              << pageBytes << " page bytes, expected FPR "
+              << bloom.table.expectedFalsePositiveRate() * 100 << "%\n";
+    std::cout << "  bloom probes: " << bloomStats.probes
+              << ", negatives " << bloomStats.negatives
+              << ", false positives " << bloomStats.falsePositives;
+    if (absent > 0) {
+        std::cout << " (observed FPR " << 100.0 * bloomStats.falsePositives / absent << "%)";
+    }
+    if (bloomStats.probes > 0) {
+        std::cout << ", avg probe " << bloomStats.probeNanos / bloomStats.probes << " ns";
+    }
+    std::cout << "\n";
+}
+
+TableData Table::orderBy(const OrderBy& keys, size_t limit) {
+    TableData result;
+    orderBy(keys, limit, [&result](const Row& row) { result.push_back(row); });
+    return result;
+}
+
+bool Table::orderBy(const OrderBy& keys, size_t limit, const RowSink& emit) {
+    Sorter sorter(schema, keys, sortMemoryBudget, filename);
+    if (!lsm && loaded) {
+        const RowStore& rows = rowStore;
+        return sorter.sort(rows.getData(), limit, emit);
+    }
+
+    // Pages or merged runs are fed to the sorter as they are read
+    return sorter.sort([this](const RowSink& add) {
+        scanMatching({}, [&add](const Row& row) {
+            add(row);
+            return true;
+        });
+    }, limit, emit);
+}
+
+void Table::setSortMemoryBudget(size_t bytes) {
+    sortMemoryBudget = bytes;
+}
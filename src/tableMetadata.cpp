@@ -0,0 +1,29 @@
+#include "TableMetadata.hpp"
+
+void updateColumnStats(ColumnStats& stats, const Value& value) {
+    if (!stats.hasValue) {
+        stats.hasValue = true;
+        stats.min = value;
+        stats.max = value;
+        return;
+    }
+
+    if (value < stats.min) stats.min = value;
+    if (stats.max < value) stats.max = value;
+}
+
+void mergeColumnStats(ColumnStats& into, const ColumnStats& from) {
+    if (!from.hasValue) return;
+
+    updateColumnStats(into, from.min);
+    updateColumnStats(into, from.max);
+}
+
+bool statsOverlap(const ColumnStats& stats, const Value& low, const Value& high) {
+    if (!stats.hasValue) return false;
+
+    // Stats of another type cannot be compared meaningfully; keep the page
+    if (stats.min.index() != low.index() || stats.max.index() != high.index()) return true;
+
+    return !(high < stats.min || stats.max < low);
+}
@@ -0,0 +1,185 @@
+#include <cassert>
+#include <iostream>
+#include <filesystem>
+#include "../include/Table.hpp"
+
+void cleanup_test_files() {
+    std::filesystem::remove("test_bloom.db");
+    std::filesystem::remove("test_bloom_churn.db");
+    std::filesystem::remove("test_bloom_zero.db");
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::current_path())) {
+        if (entry.path().filename().string().rfind("test_bloom_lsm.db", 0) == 0) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+void test_filter() {
+    std::cout << "Testing blocked Bloom filter...\n";
+    BloomFilter filter(10000, DEFAULT_BLOOM_BITS_PER_KEY);
+
+    for (int i = 0; i < 10000; i++) {
+        filter.insert(hashValue(i));
+    }
+    for (int i = 0; i < 10000; i++) {
+        assert(filter.mayContain(hashValue(i)));
+    }
+
+    size_t falsePositives = 0;
+    for (int i = 10000; i < 110000; i++) {
+        if (filter.mayContain(hashValue(i))) falsePositives++;
+    }
+    double observed = falsePositives / 100000.0;
+    double expected = filter.expectedFalsePositiveRate();
+    assert(observed < 0.03);
+    assert(expected > 0.0 && expected < 0.03);
+
+    std::vector<char> bytes;
+    filter.serialize(bytes);
+    BloomFilter copy;
+    size_t offset = 0;
+    assert(copy.deserialize(bytes.data(), bytes.size(), offset));
+    assert(offset == bytes.size());
+    assert(copy.size() == filter.size());
+    assert(copy.mayContain(hashValue(42)));
+
+    BloomFilter strings(2, DEFAULT_BLOOM_BITS_PER_KEY);
+    strings.insert(hashValue(std::string("alice")));
+    assert(strings.mayContain(hashValue(std::string("alice"))));
+
+    std::cout << "✓ Bloom filter tests passed\n";
+}
+
+void test_table_lookups() {
+    std::cout << "Testing Bloom-filtered table lookups...\n";
+    const std::string filename = "test_bloom.db";
+    Schema schema = {{"id", INT}, {"email", STRING}};
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, schema);
+        assert(!table.enableBloomFilter(5));
+        assert(table.enableBloomFilter(1));
+        for (int i = 0; i < 2000; i++) {
+            table.getRowStore().insert({i, "user" + std::to_string(i) + "@example.com"});
+        }
+        table.flush();
+        assert(table.getMetadata().bloom.pages.size() == table.getMetadata().pageCount);
+    }
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary);
+        assert(table.getMetadata().bloom.enabled);
+        assert(table.getMetadata().bloom.keyColumn == 1);
+
+        auto found = table.findByKey(std::string("user1234@example.com"));
+        assert(found.size() == 1);
+        assert(std::get<int>(found[0][0]) == 1234);
+
+        for (int i = 0; i < 1000; i++) {
+            auto missing = table.findByKey("nobody" + std::to_string(i) + "@example.com");
+            assert(missing.empty());
+        }
+
+        const BloomStats& stats = table.getBloomStats();
+        assert(stats.probes == 1001);
+        assert(stats.negatives + stats.falsePositives == 1000);
+        assert(stats.negatives > 950);
+        table.printStats();
+
+        // Unflushed inserts make the filters stale, so lookups fall back to memory
+        table.load();
+        table.getRowStore().insert({5000, std::string("new@example.com")});
+        assert(table.mayContain(std::string("new@example.com")));
+        assert(table.findByKey(std::string("new@example.com")).size() == 1);
+    }
+
+    std::cout << "✓ Table lookup tests passed\n";
+}
+
+void test_filters_follow_incremental_flush() {
+    std::cout << "Testing Bloom filters across incremental flushes...\n";
+    const std::string filename = "test_bloom_churn.db";
+    Schema schema = {{"id", INT}, {"payload", STRING}};
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, schema);
+        for (int i = 0; i < 300; i++) {
+            table.getRowStore().insert({i, std::string(50, 'p')});
+        }
+        table.flush();
+
+        // Enabling on a populated table rebuilds every page's filter
+        table.enableBloomFilter(0);
+        table.flush();
+        assert(table.getMetadata().bloom.table.size() == 300);
+
+        for (int round = 0; round < 5; round++) {
+            table.getRowStore().deleteWhere([&](const Row& row) {
+                return std::get<int>(row[0]) < 300 && std::get<int>(row[0]) % 5 == round;
+            });
+            for (int i = 0; i < 60; i++) {
+                table.getRowStore().insert({1000 * (round + 1) + i, std::string(50, 'n')});
+            }
+            table.flush();
+        }
+    }
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary);
+        assert(table.rowCount() == 300);
+
+        for (int round = 0; round < 5; round++) {
+            for (int i = 0; i < 60; i++) {
+                assert(table.findByKey(1000 * (round + 1) + i).size() == 1);
+            }
+        }
+        for (int i = 0; i < 300; i++) {
+            assert(table.findByKey(i).empty());
+        }
+    }
+
+    std::cout << "✓ Incremental flush tests passed\n";
+}
+
+void test_signed_zero_keys() {
+    std::cout << "Testing signed zero keys...\n";
+    Schema schema = {{"price", DOUBLE}, {"id", INT}};
+
+    {
+        Table table("test_bloom_zero.db", std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, schema);
+        assert(table.enableBloomFilter(0));
+        table.insert({0.0, 1});
+        table.insert({-0.0 - 1.0, 2});
+        table.flush();
+    }
+
+    // -0.0 == 0.0, so the filters must not rule either one out
+    Table table("test_bloom_zero.db", std::ios::in | std::ios::out | std::ios::binary);
+    assert(hashValue(-0.0) == hashValue(0.0));
+    assert(table.mayContain(-0.0));
+    assert(table.findByKey(-0.0).size() == 1);
+    assert(table.findByKey(0.0).size() == 1);
+
+    LsmOptions options;
+    options.backgroundCompaction = false;
+    Table lsm("test_bloom_lsm.db", std::ios::trunc, schema, options);
+    assert(lsm.insert({-0.0, 3}));
+    lsm.flush();
+    assert(lsm.findByKey(0.0).size() == 1);
+
+    std::cout << "✓ Signed zero tests passed\n";
+}
+
+int main() {
+    std::cout << "\n=== Bloom Filter Tests ===\n";
+    cleanup_test_files();
+
+    test_filter();
+    test_table_lookups();
+    test_filters_follow_incremental_flush();
+    test_signed_zero_keys();
+
+    cleanup_test_files();
+    std::cout << "\n✓ All Bloom filter tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include <cassert>
+#include <iostream>
+#include <filesystem>
+#include "../include/Catalog.hpp"
+
+void cleanup_test_files() {
+    std::filesystem::remove("test_header.db");
+    std::filesystem::remove("test_legacy.db");
+    std::filesystem::remove("test_catalog.cat");
+    std::filesystem::remove("test_catalog_users.db");
+    std::filesystem::remove("test_catalog_orders.db");
+    std::filesystem::remove("test_catalog_v1.cat");
+    std::filesystem::remove("test_catalog_lazy.db");
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        if (entry.path().filename().string().rfind("test_catalog_events.db", 0) == 0) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+void test_self_describing_header() {
+    std::cout << "Testing self-describing header...\n";
+    const std::string filename = "test_header.db";
+    Schema schema = {{"id", INT}, {"name", STRING}, {"score", DOUBLE}};
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, schema);
+        for (int i = 0; i < 1000; i++) {
+            table.getRowStore().insert({i, std::string("user") + std::to_string(i), i * 0.5});
+        }
+        table.flush();
+        assert(table.getMetadata().pageCount > 1);
+    }
+
+    // Open without a schema and without loading any data page
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary);
+        const TableMetadata& metadata = table.getMetadata();
+
+        assert(metadata.version == FORMAT_VERSION);
+        assert(table.getSchema() == schema);
+        assert(table.rowCount() == 1000);
+        assert(!table.isLoaded());
+        assert(metadata.pages.size() == metadata.pageCount);
+
+        assert(std::get<int>(metadata.stats[0].min) == 0);
+        assert(std::get<int>(metadata.stats[0].max) == 999);
+        assert(std::get<std::string>(metadata.stats[1].min) == "user0");
+
+        // Rows are appended in id order, so most pages can be skipped
+        size_t candidatePages = 0;
+        for (const auto& page : metadata.pages) {
+            if (statsOverlap(page.stats[0], Value(500), Value(509))) candidatePages++;
+        }
+        assert(candidatePages == 1);
+
+        auto rows = table.selectRange(0, 500, 509);
+        assert(rows.size() == 10);
+        assert(std::get<int>(rows[0][0]) == 500);
+
+        auto byName = table.selectRange(1, std::string("user998"), std::string("user999"));
+        assert(byName.size() == 2);
+
+        table.load();
+        assert(table.getRowStore().rowCount() == 1000);
+        assert(table.selectRange(2, 0.0, 1.0).size() == 3);
+    }
+
+    std::cout << "✓ Header tests passed\n";
+}
+
+void test_legacy_file() {
+    std::cout << "Testing legacy file compatibility...\n";
+    const std::string filename = "test_legacy.db";
+    Schema schema = {{"id", INT}};
+
+    {
+        FileManager fileManager;
+        Page page;
+        page.used_bytes += fileManager.serializeRow({7}, page.getWritePtr(), PAGE_SIZE);
+        page.used_bytes += fileManager.serializeRow({8}, page.getWritePtr(), PAGE_SIZE);
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        uint32_t pageCount = 1;
+        out.write(reinterpret_cast<const char*>(&pageCount), sizeof(pageCount));
+        out.seekp(PAGE_SIZE + sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(&page.used_bytes), sizeof(page.used_bytes));
+        out.write(page.data.data(), PAGE_SIZE);
+    }
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary, schema);
+        assert(table.getMetadata().version == LEGACY_FORMAT_VERSION);
+        assert(table.selectRange(0, 8, 8).size() == 1);
+
+        table.load();
+        assert(table.rowCount() == 2);
+        table.flush();
+    }
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary);
+        assert(table.getMetadata().version == FORMAT_VERSION);
+        assert(table.rowCount() == 2);
+    }
+
+    std::cout << "✓ Legacy file tests passed\n";
+}
+
+void test_catalog() {
+    std::cout << "Testing catalog...\n";
+    Schema users = {{"id", INT}, {"name", STRING}};
+    Schema orders = {{"id", INT}, {"total", DOUBLE}};
+
+    {
+        Catalog catalog("test_catalog.cat");
+        assert(catalog.tableNames().empty());
+        assert(catalog.createTable("users", "test_catalog_users.db", users));
+        assert(catalog.createTable("orders", "test_catalog_orders.db", orders));
+        assert(!catalog.createTable("users", "test_catalog_users.db", users));
+        // Saved through a temporary file that is renamed into place
+        assert(!std::filesystem::exists("test_catalog.cat.tmp"));
+
+        // Another name on a file that is taken or already on disk would truncate it
+        assert(!catalog.createTable("users2", "test_catalog_users.db", users));
+        assert(!catalog.createTable("users3", "./test_catalog_users.db", users));
+        assert(!catalog.createTable("header", "test_header.db", users));
+        assert(catalog.tableNames().size() == 2);
+        assert(Table("test_header.db", std::ios::in | std::ios::out | std::ios::binary).rowCount() == 1000);
+
+        auto table = catalog.openTable("users");
+        assert(table != nullptr);
+        assert(table->rowCount() == 0);
+        table->load();
+        table->getRowStore().insert({1, std::string("Alice")});
+        table->getRowStore().insert({2, std::string("Bob")});
+        table->flush();
+    }
+
+    {
+        Catalog catalog("test_catalog.cat");
+        auto names = catalog.tableNames();
+        assert(names.size() == 2);
+        assert(names[0] == "users" && names[1] == "orders");
+        assert(catalog.find("orders")->schema == orders);
+
+        auto table = catalog.openTable("users");
+        assert(table->rowCount() == 2);
+        assert(catalog.openTable("missing") == nullptr);
+
+        assert(catalog.dropTable("orders"));
+        assert(!catalog.dropTable("orders"));
+
+        // A dropped table's file stays on disk and is not reused
+        assert(!catalog.createTable("orders", "test_catalog_orders.db", orders));
+    }
+
+    {
+        Catalog catalog("test_catalog.cat");
+        assert(catalog.tableNames().size() == 1);
+    }
+
+    std::cout << "✓ Catalog tests passed\n";
+}
+
+void test_unloaded_writes() {
+    std::cout << "Testing writes to an unloaded table...\n";
+    Schema schema = {{"id", INT}, {"kind", STRING}};
+
+    {
+        Catalog catalog("test_catalog.cat");
+        assert(catalog.createTable("lazy", "test_catalog_lazy.db", schema));
+        auto table = catalog.openTable("lazy");
+        for (int i = 0; i < 100; i++) {
+            table->insert({i, std::string("old")});
+        }
+        table->flush();
+    }
+
+    {
+        Catalog catalog("test_catalog.cat");
+        auto table = catalog.openTable("lazy");
+        assert(!table->isLoaded() && table->rowCount() == 100);
+
+        // Flushing an untouched table must not rewrite it from the empty RowStore
+        table->flush();
+        assert(table->insert({100, std::string("new")}));
+        assert(table->isLoaded() && table->rowCount() == 101);
+        table->flush();
+    }
+
+    {
+        Catalog catalog("test_catalog.cat");
+        auto table = catalog.openTable("lazy");
+        assert(table->rowCount() == 101);
+        table->getRowStore().insert({101, std::string("new")});
+        table->flush();
+    }
+
+    {
+        Catalog catalog("test_catalog.cat");
+        auto table = catalog.openTable("lazy");
+        assert(table->rowCount() == 102);
+        table->load();
+        assert(std::get<std::string>((*table->getRowStore().getRow(0))[1]) == "old");
+        assert(table->selectRange(1, std::string("new"), std::string("new")).size() == 2);
+    }
+
+    std::cout << "✓ Unloaded table write tests passed\n";
+}
+
+void test_catalog_engines() {
+    std::cout << "Testing catalog storage engines...\n";
+    Schema events = {{"id", INT}, {"kind", STRING}};
+    LsmOptions options;
+    options.keyColumn = 0;
+    options.memtableBytes = 1024;
+    options.runsPerLevel = 3;
+
+    {
+        Catalog catalog("test_catalog.cat");
+        LsmOptions badKey = options;
+        badKey.keyColumn = 5;
+        assert(!catalog.createTable("events", "test_catalog_events.db", events, badKey));
+        assert(catalog.createTable("events", "test_catalog_events.db", events, options));
+
+        auto table = catalog.openTable("events");
+        assert(table->getEngine() == LSM);
+        for (int i = 0; i < 200; i++) {
+            assert(table->insert({i, std::string("click")}));
+        }
+    }
+
+    {
+        Catalog catalog("test_catalog.cat");
+        auto entry = catalog.find("events");
+        assert(entry->engine == LSM);
+        assert(entry->lsmOptions.memtableBytes == 1024 && entry->lsmOptions.runsPerLevel == 3);
+        assert(catalog.find("users")->engine == ROW_STORE);
+
+        auto table = catalog.openTable("events");
+        assert(table->getEngine() == LSM);
+        assert(table->rowCount() == 200);
+        assert(table->findByKey(150).size() == 1);
+    }
+
+    // A version 1 catalog has no engine field and opens as row store
+    {
+        std::ofstream out("test_catalog_v1.cat", std::ios::binary | std::ios::trunc);
+        auto put = [&out](auto value) { out.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+        auto putString = [&](const std::string& str) {
+            put(static_cast<uint32_t>(str.size()));
+            out.write(str.data(), str.size());
+        };
+        put(CATALOG_MAGIC);
+        put(static_cast<uint32_t>(1));
+        put(static_cast<uint32_t>(1));
+        putString("users");
+        putString("test_catalog_users.db");
+        put(static_cast<uint32_t>(2));
+        putString("id");
+        put(static_cast<uint8_t>(INT));
+        putString("name");
+        put(static_cast<uint8_t>(STRING));
+    }
+
+    {
+        Catalog catalog("test_catalog_v1.cat");
+        assert(catalog.tableNames().size() == 1);
+        assert(catalog.find("users")->engine == ROW_STORE);
+        assert(catalog.openTable("users")->rowCount() == 2);
+    }
+
+    std::cout << "✓ Catalog engine tests passed\n";
+}
+
+int main() {
+    std::cout << "\n=== Catalog and Header Tests ===\n";
+    cleanup_test_files();
+
+    test_self_describing_header();
+    test_legacy_file();
+    test_catalog();
+    test_unloaded_writes();
+    test_catalog_engines();
+
+    cleanup_test_files();
+    std::cout << "\n✓ All catalog tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <cassert>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include "../include/Table.hpp"
+
+void cleanup_test_files() {
+    std::filesystem::remove("test_churn.db");
+    std::filesystem::remove("test_relocate.db");
+}
+
+void test_free_space_map() {
+    std::cout << "Testing free-space map...\n";
+    FreeSpaceMap map;
+
+    map.setFreeBytes(1, 10);
+    map.setFreeBytes(2, 100);
+    map.setFreeBytes(3, PAGE_SIZE);
+    assert(map.pageCount() == 3);
+
+    assert(map.findPage(8) == 2u);
+    assert(map.findPage(100) == 3u);
+    assert(map.findPage(4000) == 3u);
+    assert(!map.findPage(PAGE_SIZE).has_value());
+
+    // Levels round down so a found page always has room
+    assert(map.freeBytes(2) <= 100);
+
+    FreeSpaceMap copy;
+    copy.deserialize(map.serialize());
+    assert(copy.pageCount() == 3);
+    assert(copy.findPage(100) == 3u);
+
+    // The max-tree must agree with a first-fit scan as pages grow and change
+    FreeSpaceMap grown;
+    std::vector<size_t> freeBytes;
+    for (int step = 0; step < 5000; step++) {
+        uint32_t pageNum = (step % 3 == 0) ? freeBytes.size() + 1 : 1 + (step * 7919) % (freeBytes.size() + 1);
+        size_t bytes = (step * 104729) % PAGE_SIZE;
+        grown.setFreeBytes(pageNum, bytes);
+        freeBytes.resize(std::max<size_t>(freeBytes.size(), pageNum), 0);
+        freeBytes[pageNum - 1] = grown.freeBytes(pageNum);
+
+        size_t needed = (step * 31) % PAGE_SIZE;
+        std::optional<uint32_t> expected;
+        for (size_t i = 0; i < freeBytes.size() && !expected.has_value(); i++) {
+            if (freeBytes[i] >= needed) expected = i + 1;
+        }
+        assert(grown.findPage(needed) == expected);
+    }
+    grown.resize(10);
+    assert(!grown.findPage(PAGE_SIZE - 1).has_value() || *grown.findPage(PAGE_SIZE - 1) <= 10);
+
+    std::cout << "✓ Free-space map tests passed\n";
+}
+
+void test_churn_reuses_space() {
+    std::cout << "Testing delete/insert churn reuses pages...\n";
+    const std::string filename = "test_churn.db";
+    Schema schema = {{"id", INT}, {"payload", STRING}};
+    std::string payload(100, 'x');
+
+    Table table(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, schema);
+    for (int i = 0; i < 500; i++) {
+        table.getRowStore().insert({i, payload});
+    }
+    table.flush();
+
+    uint32_t initialPages = table.getMetadata().pageCount;
+    auto initialSize = std::filesystem::file_size(filename);
+    int nextId = 500;
+
+    for (int cycle = 0; cycle < 10; cycle++) {
+        size_t deleted = table.getRowStore().deleteWhere([&](const Row& row) {
+            return std::get<int>(row[0]) % 10 == cycle;
+        });
+
+        for (size_t i = 0; i < deleted; i++) {
+            table.getRowStore().insert({nextId * 10 + cycle, payload});
+            nextId++;
+        }
+
+        table.flush();
+        assert(table.getMetadata().pageCount == initialPages);
+        assert(table.rowCount() == 500);
+    }
+
+    assert(std::filesystem::file_size(filename) == initialSize);
+
+    Table reopened(filename, std::ios::in | std::ios::out | std::ios::binary);
+    assert(reopened.rowCount() == 500);
+    reopened.load();
+    assert(reopened.getRowStore().rowCount() == 500);
+
+    std::vector<int> ids;
+    for (const auto& row : reopened.getRowStore().getData()) {
+        ids.push_back(std::get<int>(row[0]));
+    }
+    std::sort(ids.begin(), ids.end());
+    assert(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+
+    std::cout << "✓ Churn tests passed\n";
+}
+
+void test_updates_relocate_rows() {
+    std::cout << "Testing updates that outgrow their page...\n";
+    const std::string filename = "test_relocate.db";
+    Schema schema = {{"id", INT}, {"payload", STRING}};
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, schema);
+        for (int i = 0; i < 40; i++) {
+            table.getRowStore().insert({i, std::string(90, 'a')});
+        }
+        table.flush();
+        assert(table.getMetadata().pageCount == 1);
+
+        assert(table.getRowStore().update(0, {0, std::string(2000, 'b')}));
+        table.flush();
+        assert(table.getMetadata().pageCount == 2);
+    }
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary, schema);
+        table.load();
+        assert(table.getRowStore().rowCount() == 40);
+
+        auto updated = table.getRowStore().select([](const Row& row) {
+            return std::get<int>(row[0]) == 0;
+        });
+        assert(updated.size() == 1);
+        assert(std::get<std::string>(updated[0][1]).size() == 2000);
+
+        // Replacing the contents still rewrites the whole file
+        table.getRowStore().loadData({{1, std::string("only")}});
+        table.flush();
+    }
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary, schema);
+        assert(table.rowCount() == 1);
+    }
+
+    std::cout << "✓ Relocation tests passed\n";
+}
+
+int main() {
+    std::cout << "\n=== Free-Space Map Tests ===\n";
+    cleanup_test_files();
+
+    test_free_space_map();
+    test_churn_reuses_space();
+    test_updates_relocate_rows();
+
+    cleanup_test_files();
+    std::cout << "\n✓ All free-space map tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,326 @@
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <filesystem>
+#include <thread>
+#include "../include/Table.hpp"
+
+const std::string LSM_PATH = "test_lsm.db";
+
+void cleanup_test_files() {
+    std::filesystem::path dir = std::filesystem::current_path();
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(LSM_PATH, 0) == 0) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+LsmOptions smallOptions(bool background) {
+    LsmOptions options;
+    options.keyColumn = 0;
+    options.memtableBytes = 4096;
+    options.runsPerLevel = 3;
+    options.backgroundCompaction = background;
+    return options;
+}
+
+void test_put_get_remove() {
+    std::cout << "Testing LSM put/get/remove...\n";
+    Schema schema = {{"id", INT}, {"name", STRING}, {"score", DOUBLE}};
+    LsmStore store(LSM_PATH, std::ios::trunc, schema, smallOptions(false));
+
+    assert(!store.put({1, std::string("bad")}));
+    assert(!store.remove(std::string("not an int")));
+
+    for (int i = 0; i < 500; i++) {
+        assert(store.put({i, "name" + std::to_string(i), i * 1.5}));
+    }
+    assert(store.getStats().flushes > 0);
+
+    // Overwrites and deletes land in newer runs than the originals
+    for (int i = 0; i < 500; i += 10) {
+        store.put({i, std::string("updated"), -1.0});
+    }
+    for (int i = 5; i < 500; i += 10) {
+        store.remove(i);
+    }
+    store.flush();
+
+    auto row = store.get(20);
+    assert(row.has_value() && std::get<std::string>((*row)[1]) == "updated");
+    assert(!store.get(25).has_value());
+    row = store.get(7);
+    assert(row.has_value() && std::get<double>((*row)[2]) == 10.5);
+    assert(!store.get(10000).has_value());
+
+    auto rows = store.scan();
+    assert(rows.size() == 450);
+    for (size_t i = 1; i < rows.size(); i++) {
+        assert(std::get<int>(rows[i - 1][0]) < std::get<int>(rows[i][0]));
+    }
+
+    std::cout << "✓ Put/get/remove tests passed\n";
+}
+
+void test_memtable_overwrites() {
+    std::cout << "Testing LSM memtable overwrites...\n";
+    Schema schema = {{"id", INT}, {"name", STRING}, {"score", DOUBLE}};
+    LsmStore store(LSM_PATH, std::ios::trunc, schema, smallOptions(false));
+
+    // Replaced entries stop counting towards the memtable size
+    for (int i = 0; i < 5000; i++) {
+        assert(store.put({i % 4, "name" + std::to_string(i), i * 1.0}));
+        assert(store.remove(i % 4 + 100));
+    }
+    assert(store.getStats().flushes == 0);
+    assert(store.entryCount() == 8);
+
+    auto row = store.get(3);
+    assert(row.has_value() && std::get<double>((*row)[2]) == 4999.0);
+
+    std::cout << "✓ Memtable overwrite tests passed\n";
+}
+
+void test_compaction() {
+    std::cout << "Testing LSM compaction...\n";
+    Schema schema = {{"id", INT}, {"payload", STRING}};
+    // Each round rewrites the same 300 keys, so the memtable must hold
+    // fewer than that for every round to reach disk
+    LsmOptions options = smallOptions(true);
+    options.memtableBytes = 1024;
+
+    {
+        LsmStore store(LSM_PATH, std::ios::trunc, schema, options);
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < 300; i++) {
+                store.put({i, "r" + std::to_string(round) + "-" + std::to_string(i)});
+            }
+        }
+        for (int i = 0; i < 300; i += 2) {
+            store.remove(i);
+        }
+        store.flush();
+        store.compact();
+
+        assert(store.getStats().compactions > 0);
+        for (size_t runs : store.levelSizes()) {
+            assert(runs < 3);
+        }
+
+        assert(!store.get(100).has_value());
+        auto row = store.get(101);
+        assert(row.has_value() && std::get<std::string>((*row)[1]) == "r3-101");
+        assert(store.scan().size() == 150);
+    }
+
+    // Reopen from the manifest
+    {
+        LsmStore store(LSM_PATH, std::ios::in | std::ios::out, schema, options);
+        assert(store.scan().size() == 150);
+        auto row = store.get(299);
+        assert(row.has_value() && std::get<std::string>((*row)[1]) == "r3-299");
+        assert(!store.get(298).has_value());
+    }
+
+    std::cout << "✓ Compaction tests passed\n";
+}
+
+void test_failed_compaction() {
+    std::cout << "Testing failed LSM compaction...\n";
+    Schema schema = {{"id", INT}, {"payload", STRING}};
+    LsmOptions options = smallOptions(false);
+    options.memtableBytes = 1 << 20;
+
+    {
+        LsmStore store(LSM_PATH, std::ios::trunc, schema, options);
+        // Runs 1-3 fill level 0; the directory makes the merged run 4 unwritable
+        std::filesystem::create_directory(LSM_PATH + ".run.4");
+        for (int run = 0; run < 3; run++) {
+            for (int i = run * 100; i < (run + 1) * 100; i++) {
+                store.put({i, "v" + std::to_string(i)});
+            }
+            store.flush();
+        }
+
+        assert(!store.compact());
+        assert(store.levelSizes() == std::vector<size_t>{3});
+        assert(store.getStats().compactions == 0);
+        assert(store.scan().size() == 300);
+        assert(store.get(150).has_value());
+
+        // The next successful flush lets compaction retry
+        std::filesystem::remove(LSM_PATH + ".run.4");
+        store.put({1000, std::string("late")});
+        store.flush();
+        assert(store.compact());
+        assert(store.getStats().compactions > 0);
+        assert(store.scan().size() == 301);
+    }
+
+    {
+        LsmStore store(LSM_PATH, std::ios::in | std::ios::out, schema, options);
+        assert(store.scan().size() == 301);
+    }
+
+    std::cout << "✓ Failed compaction tests passed\n";
+}
+
+void test_streaming_merge() {
+    std::cout << "Testing LSM merge across multi-page runs...\n";
+    Schema schema = {{"id", INT}, {"payload", STRING}};
+    LsmOptions options = smallOptions(false);
+    options.memtableBytes = 64 * 1024;
+    options.runsPerLevel = 3;
+
+    std::map<int, std::string> expected;
+    LsmStore store(LSM_PATH, std::ios::trunc, schema, options);
+    for (int round = 0; round < 12; round++) {
+        // Overlapping key ranges so every merge interleaves its inputs
+        for (int i = round * 500; i < round * 500 + 3000; i += 3) {
+            std::string payload = "r" + std::to_string(round) + "-" + std::to_string(i);
+            store.put({i, payload});
+            expected[i] = payload;
+        }
+        for (int i = round * 700; i < round * 700 + 300; i += 7) {
+            store.remove(i);
+            expected.erase(i);
+        }
+    }
+    store.flush();
+    assert(store.compact());
+    assert(store.getStats().compactions > 0);
+
+    auto rows = store.scan();
+    assert(rows.size() == expected.size());
+    assert(store.rowCount() == expected.size());
+    assert(store.entryCount() >= expected.size());
+    auto it = expected.begin();
+    for (const auto& row : rows) {
+        assert(std::get<int>(row[0]) == it->first);
+        assert(std::get<std::string>(row[1]) == it->second);
+        ++it;
+    }
+
+    std::cout << "✓ Streaming merge tests passed\n";
+}
+
+void test_filters_and_fences() {
+    std::cout << "Testing LSM Bloom filters and fence pointers...\n";
+    Schema schema = {{"id", INT}, {"name", STRING}};
+    LsmOptions options = smallOptions(false);
+    options.runsPerLevel = 100;
+    LsmStore store(LSM_PATH, std::ios::trunc, schema, options);
+
+    // Disjoint key ranges per run: most runs are ruled out without I/O
+    for (int i = 0; i < 2000; i++) {
+        store.put({i, "user" + std::to_string(i)});
+    }
+    store.flush();
+    assert(store.levelSizes().size() == 1 && store.levelSizes()[0] > 3);
+
+    for (int i = 0; i < 2000; i += 7) {
+        auto row = store.get(i);
+        assert(row.has_value() && std::get<int>((*row)[0]) == i);
+    }
+
+    const LsmStats& stats = store.getStats();
+    assert(stats.bloomSkips + stats.fenceSkips > stats.pageReads);
+
+    uint64_t reads = stats.pageReads;
+    for (int i = 5000; i < 5100; i++) {
+        assert(!store.get(i).has_value());
+    }
+    assert(stats.pageReads - reads < 10);
+
+    std::cout << "✓ Bloom filter and fence pointer tests passed\n";
+}
+
+void test_concurrent_writers() {
+    std::cout << "Testing LSM concurrent writers...\n";
+    Schema schema = {{"id", INT}, {"name", STRING}};
+    LsmStore store(LSM_PATH, std::ios::trunc, schema, smallOptions(true));
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; t++) {
+        writers.emplace_back([&store, t] {
+            for (int i = 0; i < 500; i++) {
+                int key = t * 1000 + i;
+                store.put({key, "w" + std::to_string(key)});
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    store.flush();
+    store.compact();
+
+    assert(store.scan().size() == 2000);
+    for (int t = 0; t < 4; t++) {
+        assert(store.get(t * 1000 + 499).has_value());
+    }
+
+    std::cout << "✓ Concurrent writer tests passed\n";
+}
+
+void test_table_engine() {
+    std::cout << "Testing LSM-backed Table...\n";
+    Schema schema = {{"id", INT}, {"name", STRING}, {"salary", DOUBLE}};
+
+    {
+        Table table(LSM_PATH, std::ios::trunc, schema, smallOptions(true));
+        assert(table.getEngine() == LSM);
+        LsmStore* store = table.getLsmStore();
+        assert(store != nullptr);
+
+        store->put({3, std::string("Charlie"), 55000.0});
+        store->put({1, std::string("Alice"), 50000.0});
+        store->put({2, std::string("Bob"), 65000.0});
+        table.flush();
+
+        assert(table.rowCount() == 3);
+        assert(table.findByKey(2).size() == 1);
+
+        // RowStore writes would never be persisted, so they are refused
+        RowStore& rows = table.getRowStore();
+        assert(rows.isReadOnly());
+        assert(!rows.insert({4, std::string("Dana"), 1.0}));
+        assert(rows.deleteWhere([](const Row&) { return true; }) == 0);
+        assert(table.insert({4, std::string("Dana"), 1.0}));
+        assert(table.rowCount() == 4);
+        assert(table.getLsmStore()->remove(4));
+        assert(table.findByKey(9).empty());
+
+        auto range = table.selectRange(2, 52000.0, 70000.0);
+        assert(range.size() == 2);
+
+        auto top = table.orderBy({{2, DESCENDING}}, 1);
+        assert(top.size() == 1 && std::get<int>(top[0][0]) == 2);
+    }
+
+    Table rowTable("test_lsm_rows.db", std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, schema);
+    assert(rowTable.getEngine() == ROW_STORE);
+    assert(rowTable.getLsmStore() == nullptr);
+    std::filesystem::remove("test_lsm_rows.db");
+
+    std::cout << "✓ LSM-backed Table tests passed\n";
+}
+
+int main() {
+    std::cout << "\n=== LSM Tests ===\n";
+    cleanup_test_files();
+    test_put_get_remove();
+    cleanup_test_files();
+    test_memtable_overwrites();
+    test_compaction();
+    test_failed_compaction();
+    test_streaming_merge();
+    test_filters_and_fences();
+    test_concurrent_writers();
+    test_table_engine();
+    cleanup_test_files();
+    std::cout << "\n✓ All LSM tests passed!\n";
+    return 0;
+}
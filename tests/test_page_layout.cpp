@@ -0,0 +1,235 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <filesystem>
+#include "../include/Table.hpp"
+
+const std::ios::openmode CREATE = std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc;
+const std::ios::openmode OPEN = std::ios::in | std::ios::out | std::ios::binary;
+
+void cleanup_test_files() {
+    std::filesystem::remove("test_layout_large.db");
+    std::filesystem::remove("test_layout_v2.db");
+    std::filesystem::remove("test_layout_wide.db");
+    std::filesystem::remove("test_layout_writer.bin");
+}
+
+template <typename T>
+void putValue(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putString(std::string& out, const std::string& s) {
+    putValue(out, static_cast<uint32_t>(s.size()));
+    out += s;
+}
+
+void test_page_writer() {
+    std::cout << "Testing batched page writes...\n";
+    const std::string filename = "test_layout_writer.bin";
+    std::ofstream(filename, std::ios::binary | std::ios::trunc).close();
+
+    PageBuffer buffer;
+    for (int i = 0; i < 20; i++) {
+        std::memset(buffer.append(), 'a' + i, PAGE_SIZE);
+    }
+    for (size_t i = 0; i < buffer.pageCount(); i++) {
+        assert(reinterpret_cast<uintptr_t>(buffer.page(i)) % PAGE_SIZE == 0);
+    }
+
+    {
+        PageWriter writer(filename);
+        assert(writer.isOpen());
+        // Out of order with a gap at page 10
+        for (int i = 19; i >= 0; i--) {
+            if (i != 10) writer.add(i * PAGE_SIZE, buffer.page(i));
+        }
+        assert(writer.flush());
+    }
+
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> page(PAGE_SIZE);
+    for (int i = 0; i < 20; i++) {
+        in.seekg(i * PAGE_SIZE);
+        in.read(page.data(), PAGE_SIZE);
+        assert(in.gcount() == static_cast<std::streamsize>(PAGE_SIZE));
+        char expected = (i == 10) ? 0 : static_cast<char>('a' + i);
+        assert(page[0] == expected && page[PAGE_SIZE - 1] == expected);
+    }
+
+    std::cout << "✓ Page writer tests passed\n";
+}
+
+void test_aligned_layout() {
+    std::cout << "Testing aligned layout with parallel packing...\n";
+    const std::string filename = "test_layout_large.db";
+    Schema schema = {{"id", INT}, {"name", STRING}, {"score", DOUBLE}};
+    const int rows = 50000;
+
+    std::vector<uint32_t> rowPages;
+    {
+        Table table(filename, CREATE, schema);
+        for (int i = 0; i < rows; i++) {
+            table.insert({i, "row" + std::to_string(i % 977), i * 0.5});
+        }
+        table.flush();
+        rowPages = table.getRowStore().getRowPages();
+
+        const TableMetadata& metadata = table.getMetadata();
+        assert(metadata.version == FORMAT_VERSION);
+        assert(metadata.pages.size() == metadata.pageCount);
+
+        // Pages come back in row order whatever thread packed them
+        for (int i = 1; i < rows; i++) {
+            assert(rowPages[i] == rowPages[i - 1] || rowPages[i] == rowPages[i - 1] + 1);
+        }
+        assert(rowPages.front() == 1 && rowPages.back() == metadata.pageCount);
+    }
+
+    // Every page starts on a PAGE_SIZE boundary with no length prefix
+    assert(std::filesystem::file_size(filename) % PAGE_SIZE == 0);
+    {
+        std::fstream raw(filename, std::ios::in | std::ios::binary);
+        std::vector<char> page(PAGE_SIZE);
+        raw.seekg(PAGE_SIZE);
+        raw.read(page.data(), PAGE_SIZE);
+
+        FileManager fileManager;
+        Row first;
+        assert(fileManager.deserializeRow(page.data(), PAGE_SIZE, schema, first) > 0);
+        assert(std::get<int>(first[0]) == 0 && std::get<std::string>(first[1]) == "row0");
+    }
+
+    {
+        Table table(filename, OPEN);
+        assert(table.rowCount() == rows);
+        assert(table.selectRange(0, 31000, 31009).size() == 10);
+
+        table.load();
+        assert(table.getRowStore().getRowPages() == rowPages);
+        const TableData& data = table.getRowStore().getData();
+        for (int i = 0; i < rows; i += 997) {
+            assert(std::get<int>(data[i][0]) == i);
+            assert(std::get<double>(data[i][2]) == i * 0.5);
+        }
+
+        // Incremental flush rewrites single pages in place
+        auto size = std::filesystem::file_size(filename);
+        assert(table.getRowStore().update(25000, {-1, std::string("changed"), 0.0}));
+        table.flush();
+        assert(std::filesystem::file_size(filename) == size);
+    }
+
+    {
+        Table table(filename, OPEN);
+        TableData found = table.selectRange(0, -1, -1);
+        assert(found.size() == 1 && std::get<std::string>(found[0][1]) == "changed");
+    }
+
+    std::cout << "✓ Aligned layout tests passed\n";
+}
+
+void test_prefixed_file() {
+    std::cout << "Testing prefixed (version 2) file compatibility...\n";
+    const std::string filename = "test_layout_v2.db";
+    Schema schema = {{"id", INT}, {"name", STRING}};
+
+    {
+        FileManager fileManager;
+        Page page;
+        page.used_bytes += fileManager.serializeRow({1, std::string("one")}, page.getWritePtr(), PAGE_SIZE);
+        page.used_bytes += fileManager.serializeRow({2, std::string("two")}, page.getWritePtr(), PAGE_SIZE);
+
+        std::string header;
+        putValue(header, FILE_MAGIC);
+        putValue(header, PREFIXED_FORMAT_VERSION);
+        putValue(header, static_cast<uint32_t>(1));
+        putValue(header, static_cast<uint64_t>(2));
+        putValue(header, static_cast<uint32_t>(schema.size()));
+        for (const auto& col : schema) {
+            putString(header, col.first);
+            putValue(header, static_cast<uint8_t>(col.second));
+        }
+        for (size_t i = 0; i < schema.size(); i++) {
+            putValue(header, static_cast<uint8_t>(0));
+        }
+        putValue(header, static_cast<uint32_t>(0));
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out.write(header.data(), header.size());
+        out.seekp(PAGE_SIZE + sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(&page.used_bytes), sizeof(page.used_bytes));
+        out.write(page.data.data(), PAGE_SIZE);
+    }
+
+    {
+        Table table(filename, OPEN);
+        assert(table.getMetadata().version == PREFIXED_FORMAT_VERSION);
+        assert(table.getSchema() == schema);
+        assert(table.selectRange(0, 2, 2).size() == 1);
+
+        table.load();
+        assert(table.rowCount() == 2);
+        table.insert({3, std::string("three")});
+        table.flush();
+    }
+
+    {
+        Table table(filename, OPEN);
+        assert(table.getMetadata().version == FORMAT_VERSION);
+        assert(table.rowCount() == 3);
+        assert(std::get<std::string>(table.selectRange(0, 1, 1)[0][1]) == "one");
+    }
+
+    std::cout << "✓ Prefixed file tests passed\n";
+}
+
+void test_schema_overflow() {
+    std::cout << "Testing schema larger than the header page...\n";
+    const std::string filename = "test_layout_wide.db";
+
+    Schema schema;
+    for (int i = 0; i < 300; i++) {
+        schema.push_back({"a_rather_long_column_name_" + std::to_string(i), (i % 2 == 0) ? INT : DOUBLE});
+    }
+
+    {
+        Table table(filename, CREATE, schema);
+        for (int r = 0; r < 10; r++) {
+            Row row;
+            for (int i = 0; i < 300; i++) {
+                if (i % 2 == 0) row.push_back(r * 1000 + i);
+                else row.push_back(r + 0.25);
+            }
+            assert(table.insert(row));
+        }
+        table.flush();
+
+        bool overflow = false;
+        for (const auto& root : table.getMetadata().roots) {
+            overflow = overflow || root.kind == SCHEMA_OVERFLOW;
+        }
+        assert(overflow);
+    }
+
+    {
+        Table table(filename, OPEN);
+        assert(table.getSchema() == schema);
+        assert(table.rowCount() == 10);
+        assert(table.selectRange(298, 5298, 5298).size() == 1);
+    }
+
+    std::cout << "✓ Schema overflow tests passed\n";
+}
+
+int main() {
+    std::cout << "\n=== Page Layout Tests ===\n";
+    cleanup_test_files();
+    test_page_writer();
+    test_aligned_layout();
+    test_prefixed_file();
+    test_schema_overflow();
+    cleanup_test_files();
+    std::cout << "\n✓ All Page Layout tests passed!\n";
+    return 0;
+}
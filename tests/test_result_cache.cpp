@@ -0,0 +1,184 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <filesystem>
+#include <random>
+#include "../include/Table.hpp"
+
+const Schema SCHEMA = {{"id", INT}, {"region", STRING}, {"amount", DOUBLE}};
+
+void cleanup_test_files() {
+    std::filesystem::remove("test_cache_orders.db");
+}
+
+std::string region(int i) {
+    return "region" + std::to_string(i % 5);
+}
+
+void test_select_cache() {
+    std::cout << "Testing select result cache...\n";
+    Table table("test_cache_orders.db", std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, SCHEMA);
+    for (int i = 0; i < 1000; i++) {
+        table.insert({i, region(i), i * 1.0});
+    }
+
+    Query query;
+    query.where = {{1, CMP_EQ, std::string("region3")}};
+    query.columns = {0};
+
+    TableData first = table.select(query);
+    assert(first.size() == 200);
+    assert(table.getResultCacheStats().misses == 1);
+
+    TableData second = table.select(query);
+    assert(second == first);
+    assert(table.getResultCacheStats().hits == 1);
+
+    // Same predicate with a different projection is a different entry
+    query.columns = {0, 2};
+    assert(table.select(query).size() == 200);
+    assert(table.getResultCacheStats().misses == 2);
+    query.columns = {0};
+
+    // Every mutation path invalidates
+    RowStore& rows = table.getRowStore();
+    table.insert({1000, std::string("region3"), 1.0});
+    assert(table.select(query).size() == 201);
+
+    rows.update(0, {0, std::string("region3"), 0.0});
+    assert(table.select(query).size() == 202);
+
+    rows.deleteRow(rows.rowCount() - 1);
+    assert(table.select(query).size() == 201);
+
+    rows.updateWhere([](const Row& row) { return std::get<int>(row[0]) < 10; },
+                     [](const Row& row) { return Row{row[0], std::string("region3"), row[2]}; });
+    assert(table.select(query).size() == 208);
+
+    rows.deleteWhere([](const Row& row) { return std::get<int>(row[0]) >= 900; });
+    assert(table.select(query).size() == 188);
+
+    // Mutable access is never served from the cache
+    rows.getData()[500][1] = std::string("region3");
+    assert(table.select(query).size() == 189);
+    assert(table.select(query).size() == 189);
+
+    table.flush();
+    uint64_t hits = table.getResultCacheStats().hits;
+    assert(table.select(query).size() == 189);
+    assert(table.select(query).size() == 189);
+    assert(table.getResultCacheStats().hits == hits + 1);
+
+    // Disabled cache
+    table.setResultCacheSize(0);
+    table.select(query);
+    assert(table.getResultCacheStats().hits == hits + 1);
+
+    std::cout << "✓ Select cache tests passed\n";
+}
+
+void test_unloaded_table() {
+    std::cout << "Testing cache on an unloaded table...\n";
+    {
+        Table table("test_cache_orders.db", std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, SCHEMA);
+        for (int i = 0; i < 500; i++) {
+            table.insert({i, region(i), 2.0});
+        }
+        table.flush();
+    }
+
+    Table table("test_cache_orders.db", std::ios::in | std::ios::out | std::ios::binary);
+    std::vector<Aggregate> aggregates = {{AGG_COUNT, 0}, {AGG_SUM, 2}};
+    auto results = table.aggregate({{0, CMP_LT, 100}}, aggregates);
+    assert(std::get<int>(*results[0]) == 100);
+    assert(table.aggregate({{0, CMP_LT, 100}}, aggregates) == results);
+    assert(table.getResultCacheStats().hits == 1);
+
+    // Loading swaps disk reads for the RowStore
+    table.load();
+    table.getRowStore().insert({-1, std::string("x"), 2.0});
+    assert(std::get<int>(*table.aggregate({{0, CMP_LT, 100}}, aggregates)[0]) == 101);
+
+    std::cout << "✓ Unloaded table tests passed\n";
+}
+
+void test_materialized_views() {
+    std::cout << "Testing materialized aggregates...\n";
+    Table table("test_cache_orders.db", std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, SCHEMA);
+
+    std::vector<Condition> where = {{1, CMP_NE, std::string("region0")}};
+    std::vector<Aggregate> aggregates = {
+        {AGG_COUNT, 0}, {AGG_SUM, 2}, {AGG_MIN, 2}, {AGG_MAX, 0}, {AGG_MIN, 1}, {AGG_AVG, 2}
+    };
+    auto view = table.createView(where, aggregates);
+    assert(view.has_value());
+    assert(!table.createView({{2, CMP_EQ, 1}}, aggregates).has_value());
+    assert(!table.createView(where, {{AGG_SUM, 1}}).has_value());
+
+    // Random mutations; the view must always match a fresh scan
+    std::mt19937 rng(7);
+    RowStore& rows = table.getRowStore();
+    for (int step = 0; step < 3000; step++) {
+        int choice = rng() % 10;
+        int id = rng() % 200;
+        if (choice < 5 || rows.rowCount() == 0) {
+            table.insert({id, region(id), static_cast<double>(rng() % 1000)});
+        } else if (choice < 7) {
+            rows.update(rng() % rows.rowCount(), {id, region(id + 1), static_cast<double>(rng() % 1000)});
+        } else if (choice < 8) {
+            rows.deleteRow(rng() % rows.rowCount());
+        } else if (choice < 9) {
+            rows.deleteWhere([id](const Row& row) { return std::get<int>(row[0]) == id; });
+        } else {
+            rows.updateWhere([id](const Row& row) { return std::get<int>(row[0]) % 50 == id % 50; },
+                             [](const Row& row) { return Row{row[0], std::string("region0"), row[2]}; });
+        }
+
+        if (step % 100 == 0) {
+            Aggregator scan(aggregates);
+            const RowStore& current = rows;
+            for (const auto& row : current.getData()) {
+                if (matches(where, row)) scan.add(row);
+            }
+            auto expected = scan.results();
+            assert(current.getVersion().has_value());
+            // Sums are exact, so deletes leave no drift against the scan
+            auto actual = *table.viewResults(*view);
+            assert(expected == actual);
+            // aggregate() answers from the view
+            assert(table.aggregate(where, aggregates) == actual);
+        }
+    }
+
+    assert(table.dropView(*view));
+    assert(!table.viewResults(*view).has_value());
+
+    // Cancelling magnitudes: a running double total would report 0 here
+    AggregateView sums({}, {{AGG_SUM, 0}, {AGG_SUM, 1}, {AGG_AVG, 1}});
+    sums.add({2000000000, 1e16});
+    sums.add({2000000000, 1.0});
+    sums.add({1, 0.1});
+    sums.remove({2000000000, 1e16});
+    auto exact = sums.results();
+    assert(std::get<double>(*exact[0]) == 2000000001.0);
+    assert(std::get<double>(*exact[1]) == 1.1);
+    assert(std::get<double>(*exact[2]) == 1.1 / 2);
+
+    Aggregator scan({{AGG_SUM, 0}, {AGG_SUM, 1}, {AGG_AVG, 1}});
+    scan.add({2000000000, 1.0});
+    scan.add({1, 0.1});
+    assert(scan.results() == exact);
+
+    std::cout << "✓ Materialized aggregate tests passed\n";
+}
+
+int main() {
+    std::cout << "\n=== Result Cache Tests ===\n";
+    cleanup_test_files();
+    test_select_cache();
+    test_unloaded_table();
+    test_materialized_views();
+    cleanup_test_files();
+    std::cout << "\n✓ All Result Cache tests passed!\n";
+    return 0;
+}
@@ -110,12 +110,74 @@ void test_delete() {
     std::cout << "✓ Delete tests passed\n";
 }
 
+void test_versions_and_views() {
+    std::cout << "Testing versions and materialized views...\n";
+    Schema schema = {{"id", INT}, {"name", STRING}, {"score", DOUBLE}};
+    RowStore store(schema);
+    
+    size_t view = store.addView({{2, CMP_GE, 80.0}},
+        {{AGG_COUNT, 0}, {AGG_SUM, 2}, {AGG_MIN, 1}, {AGG_MAX, 2}});
+    assert(store.addView({{2, CMP_GE, 80.0}},
+        {{AGG_COUNT, 0}, {AGG_SUM, 2}, {AGG_MIN, 1}, {AGG_MAX, 2}}) == view);
+    assert(std::get<int>(*(*store.viewResults(view))[0]) == 0);
+    assert(!(*store.viewResults(view))[2].has_value());
+    
+    uint64_t version = *store.getVersion();
+    store.insert({1, std::string("Alice"), 95.5});
+    store.insert({2, std::string("Bob"), 85.0});
+    store.insert({3, std::string("Charlie"), 75.0});
+    assert(*store.getVersion() > version);
+    
+    auto results = *store.viewResults(view);
+    assert(std::get<int>(*results[0]) == 2);
+    assert(std::get<double>(*results[1]) == 180.5);
+    assert(std::get<std::string>(*results[2]) == "Alice");
+    assert(std::get<double>(*results[3]) == 95.5);
+    
+    // Removing the maximum falls back to the next value
+    version = *store.getVersion();
+    assert(store.deleteRow(0));
+    assert(*store.getVersion() > version);
+    results = *store.viewResults(view);
+    assert(std::get<int>(*results[0]) == 1 && std::get<double>(*results[3]) == 85.0);
+    
+    // Rows moving into and out of the view's range
+    store.update(1, {3, std::string("Aaron"), 99.0});
+    store.updateWhere([](const Row& row) { return std::get<int>(row[0]) == 2; },
+                      [](const Row& row) { return Row{row[0], row[1], 10.0}; });
+    results = *store.viewResults(view);
+    assert(std::get<int>(*results[0]) == 1);
+    assert(std::get<std::string>(*results[2]) == "Aaron");
+    
+    // Changes that touch nothing keep the version
+    version = *store.getVersion();
+    assert(store.deleteWhere([](const Row&) { return false; }) == 0);
+    assert(*store.getVersion() == version);
+    
+    // Mutable access leaves the version untracked until the rows are replaced
+    store.getData()[0][2] = 90.0;
+    assert(!store.getVersion().has_value());
+    assert(std::get<int>(*(*store.viewResults(view))[0]) == 2);
+    store.loadData(store.getData());
+    assert(store.getVersion().has_value());
+    assert(std::get<int>(*(*store.viewResults(view))[0]) == 2);
+    
+    assert(store.findView({{2, CMP_GE, 80.0}},
+        {{AGG_COUNT, 0}, {AGG_SUM, 2}, {AGG_MIN, 1}, {AGG_MAX, 2}}) == view);
+    assert(store.dropView(view));
+    assert(!store.viewResults(view).has_value());
+    assert(!store.findView({{2, CMP_GE, 80.0}}, {{AGG_COUNT, 0}}).has_value());
+    
+    std::cout << "✓ Version and view tests passed\n";
+}
+
 int main() {
     std::cout << "\n=== RowStore Unit Tests ===\n";
     test_insert();
     test_select();
     test_update();
     test_delete();
+    test_versions_and_views();
     std::cout << "\n✓ All RowStore tests passed!\n";
     return 0;
 }
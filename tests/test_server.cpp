@@ -0,0 +1,291 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <filesystem>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../include/Client.hpp"
+#include "../include/Server.hpp"
+
+const std::string SOCKET_PATH = "test_server.sock";
+const Schema SCHEMA = {{"id", INT}, {"name", STRING}, {"salary", DOUBLE}};
+
+void cleanup_test_files() {
+    std::filesystem::remove("test_server_people.db");
+    std::filesystem::remove(SOCKET_PATH);
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::current_path())) {
+        if (entry.path().filename().string().rfind("test_server_lsm.db", 0) == 0) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+std::unique_ptr<Table> peopleTable() {
+    auto table = std::make_unique<Table>(
+        "test_server_people.db",
+        std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc,
+        SCHEMA
+    );
+    for (int i = 0; i < 100; i++) {
+        table->insert({i, "person" + std::to_string(i), 1000.0 * (i % 10)});
+    }
+    table->flush();
+    return table;
+}
+
+void test_protocol() {
+    std::cout << "Testing protocol encoding...\n";
+    Request request;
+    request.id = 7;
+    request.op = OP_SELECT;
+    request.table = "people";
+    request.query.where = {{0, CMP_GE, 10}, {1, CMP_NE, std::string("x")}};
+    request.query.columns = {1, 0};
+    request.query.limit = 5;
+
+    std::vector<char> bytes;
+    assert(encodeRequest(request, bytes));
+
+    Request insert;
+    insert.id = 8;
+    insert.op = OP_INSERT;
+    insert.table = "people";
+    insert.rows = {{1, std::string("Alice"), 1.5}, {2, std::string(""), -2.0}};
+    assert(encodeRequest(insert, bytes));
+
+    // Two pipelined frames in one buffer
+    size_t frameSize = 0;
+    assert(nextFrame(bytes.data(), 3, frameSize) == FRAME_INCOMPLETE);
+    assert(nextFrame(bytes.data(), bytes.size(), frameSize) == FRAME_READY);
+
+    Request decoded;
+    assert(decodeRequest(bytes.data(), frameSize, decoded));
+    assert(decoded.id == 7 && decoded.op == OP_SELECT && decoded.table == "people");
+    assert(decoded.query.where.size() == 2 && decoded.query.where[1].op == CMP_NE);
+    assert(std::get<std::string>(decoded.query.where[1].value) == "x");
+    assert(decoded.query.columns == request.query.columns && decoded.query.limit == 5);
+
+    size_t second = 0;
+    assert(nextFrame(bytes.data() + frameSize, bytes.size() - frameSize, second) == FRAME_READY);
+    assert(decodeRequest(bytes.data() + frameSize, second, decoded));
+    assert(decoded.rows == insert.rows);
+
+    // Truncated frames are rejected rather than read past the end
+    assert(!decodeRequest(bytes.data(), frameSize - 1, decoded));
+
+    Response response;
+    response.id = 9;
+    response.values = {4, std::nullopt, 2.5};
+    bytes.clear();
+    assert(encodeResponse(response, OP_AGGREGATE, bytes));
+    Response decodedResponse;
+    assert(decodeResponse(bytes.data(), bytes.size(), OP_AGGREGATE, decodedResponse));
+    assert(decodedResponse.id == 9 && decodedResponse.values == response.values);
+
+    // A result over the frame limit still answers its id, with an error
+    Response huge;
+    huge.id = 10;
+    for (size_t i = 0; i * 4000 <= MAX_FRAME_SIZE; i++) {
+        huge.rows.push_back({static_cast<int>(i), std::string(4000, 'x'), 0.0});
+    }
+    bytes.clear();
+    assert(encodeResponse(huge, OP_SELECT, bytes));
+    assert(bytes.size() < 1024);
+    assert(decodeResponse(bytes.data(), bytes.size(), OP_SELECT, decodedResponse));
+    assert(decodedResponse.id == 10 && decodedResponse.status == STATUS_ERROR);
+    assert(decodedResponse.error == "result too large");
+
+    std::cout << "✓ Protocol tests passed\n";
+}
+
+void exerciseServer(Client& client) {
+    auto schema = client.schema("people");
+    assert(schema.has_value() && *schema == SCHEMA);
+    assert(!client.schema("missing").has_value());
+
+    auto inserted = client.insert("people", {{100, std::string("new"), 123.0}, {101, std::string("newer"), 5.0}});
+    assert(inserted.has_value() && *inserted == 2);
+
+    auto rows = client.get("people", 100);
+    assert(rows.has_value() && rows->size() == 1);
+    assert(std::get<std::string>((*rows)[0][1]) == "new");
+    assert(client.get("people", 5000)->empty());
+
+    Query query;
+    query.where = {{2, CMP_EQ, 9000.0}};
+    query.columns = {0};
+    rows = client.select("people", query);
+    assert(rows.has_value() && rows->size() == 10);
+    assert((*rows)[0].size() == 1 && std::get<int>((*rows)[0][0]) == 9);
+
+    query.where = {{2, CMP_EQ, std::string("wrong type")}};
+    assert(!client.select("people", query).has_value());
+
+    auto values = client.aggregate("people", {{0, CMP_LT, 100}},
+        {{AGG_COUNT, 0}, {AGG_SUM, 2}, {AGG_MIN, 1}, {AGG_MAX, 0}, {AGG_AVG, 2}});
+    assert(values.has_value() && values->size() == 5);
+    assert(std::get<int>(*(*values)[0]) == 100);
+    assert(std::get<double>(*(*values)[1]) == 450000.0);
+    assert(std::get<std::string>(*(*values)[2]) == "person0");
+    assert(std::get<int>(*(*values)[3]) == 99);
+    assert(std::get<double>(*(*values)[4]) == 4500.0);
+
+    values = client.aggregate("people", {{0, CMP_GT, 1000}}, {{AGG_COUNT, 0}, {AGG_MIN, 2}});
+    assert(std::get<int>(*(*values)[0]) == 0 && !(*values)[1].has_value());
+
+    // Pipelining: many requests in one write, responses in order
+    for (int i = 0; i < 200; i++) {
+        Request request;
+        request.op = (i % 2 == 0) ? OP_GET : OP_PING;
+        request.table = "people";
+        request.key = i % 100;
+        assert(client.enqueue(request) != 0);
+    }
+    assert(client.send());
+
+    for (int i = 0; i < 200; i++) {
+        Response response;
+        assert(client.receive(response));
+        assert(response.status == STATUS_OK);
+        if (i % 2 == 0) {
+            assert(response.rows.size() == 1);
+            assert(std::get<int>(response.rows[0][0]) == i % 100);
+        }
+    }
+    assert(client.pendingCount() == 0);
+    assert(client.ping());
+}
+
+void test_unix_socket() {
+    std::cout << "Testing server over a Unix socket...\n";
+    ServerOptions options;
+    options.socketPath = SOCKET_PATH;
+    options.workers = 4;
+
+    Server server(options);
+    assert(server.addTable("people", peopleTable()));
+    assert(server.start());
+
+    // Several clients at once
+    std::vector<std::thread> clients;
+    for (int t = 0; t < 4; t++) {
+        clients.emplace_back([t] {
+            Client client;
+            assert(client.connectUnix(SOCKET_PATH));
+            for (int i = 0; i < 50; i++) {
+                auto rows = client.get("people", (t * 50 + i) % 100);
+                assert(rows.has_value() && rows->size() == 1);
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+
+    Client client;
+    assert(client.connectUnix(SOCKET_PATH));
+    exerciseServer(client);
+    assert(client.flush("people"));
+    client.disconnect();
+    server.stop();
+
+    Table reopened("test_server_people.db", std::ios::in | std::ios::out | std::ios::binary);
+    assert(reopened.rowCount() == 102);
+
+    std::cout << "✓ Unix socket tests passed\n";
+}
+
+void test_half_close() {
+    std::cout << "Testing pipelined requests before a half-close...\n";
+
+    // With and without workers: requests read before EOF are still answered
+    for (size_t workers : {4, 0}) {
+        ServerOptions options;
+        options.socketPath = SOCKET_PATH;
+        options.workers = workers;
+        Server server(options);
+        assert(server.start());
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, SOCKET_PATH.c_str(), sizeof(addr.sun_path) - 1);
+        assert(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+        std::vector<char> requests;
+        for (uint32_t id = 1; id <= 3; id++) {
+            Request ping;
+            ping.id = id;
+            ping.op = OP_PING;
+            assert(encodeRequest(ping, requests));
+        }
+        assert(write(fd, requests.data(), requests.size()) == static_cast<ssize_t>(requests.size()));
+        shutdown(fd, SHUT_WR);
+
+        std::vector<char> received;
+        char chunk[256];
+        ssize_t n;
+        while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+            received.insert(received.end(), chunk, chunk + n);
+        }
+        close(fd);
+
+        size_t offset = 0;
+        for (uint32_t id = 1; id <= 3; id++) {
+            size_t frameSize = 0;
+            assert(nextFrame(received.data() + offset, received.size() - offset, frameSize) == FRAME_READY);
+            Response response;
+            assert(decodeResponse(received.data() + offset, frameSize, OP_PING, response));
+            assert(response.id == id && response.status == STATUS_OK);
+            offset += frameSize;
+        }
+        assert(offset == received.size());
+        server.stop();
+    }
+
+    std::cout << "✓ Half-close tests passed\n";
+}
+
+void test_tcp_inline() {
+    std::cout << "Testing server over TCP without workers...\n";
+    ServerOptions options;
+    options.workers = 0;
+
+    Server server(options);
+    assert(server.addTable("people", peopleTable()));
+
+    LsmOptions lsmOptions;
+    lsmOptions.memtableBytes = 4096;
+    assert(server.addTable("events", std::make_unique<Table>(
+        "test_server_lsm.db", std::ios::trunc, SCHEMA, lsmOptions)));
+    assert(server.start());
+    assert(server.getPort() != 0);
+
+    Client client;
+    assert(client.connectTcp("127.0.0.1", server.getPort()));
+    exerciseServer(client);
+
+    TableData events;
+    for (int i = 0; i < 300; i++) {
+        events.push_back({i, "event" + std::to_string(i), 1.0});
+    }
+    assert(*client.insert("events", events) == 300);
+    assert(client.get("events", 250)->size() == 1);
+    assert(std::get<int>(*(*client.aggregate("events", {}, {{AGG_COUNT, 0}}))[0]) == 300);
+
+    std::cout << "✓ TCP tests passed\n";
+}
+
+int main() {
+    std::cout << "\n=== Server Tests ===\n";
+    cleanup_test_files();
+    test_protocol();
+    test_unix_socket();
+    test_half_close();
+    test_tcp_inline();
+    cleanup_test_files();
+    std::cout << "\n✓ All Server tests passed!\n";
+    return 0;
+}
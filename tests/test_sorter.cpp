@@ -0,0 +1,252 @@
+#include <cassert>
+#include <iostream>
+#include <filesystem>
+#include <thread>
+#include "../include/Table.hpp"
+
+void test_single_column() {
+    std::cout << "Testing single column ordering...\n";
+    Schema schema = {{"id", INT}, {"name", STRING}, {"score", DOUBLE}};
+    Sorter sorter(schema, {{2, ASCENDING}});
+
+    TableData rows = {
+        {1, std::string("Alice"), 3.5},
+        {2, std::string("Bob"), -1.25},
+        {3, std::string("Charlie"), 0.0},
+        {4, std::string("Dave"), -7.0}
+    };
+
+    auto sorted = sorter.sort(rows);
+    assert(sorted.size() == 4);
+    assert(std::get<int>(sorted[0][0]) == 4);
+    assert(std::get<int>(sorted[1][0]) == 2);
+    assert(std::get<int>(sorted[2][0]) == 3);
+    assert(std::get<int>(sorted[3][0]) == 1);
+
+    Sorter byId(schema, {{0, DESCENDING}});
+    rows.push_back({-5, std::string("Eve"), 1.0});
+    sorted = byId.sort(rows);
+    assert(std::get<int>(sorted[0][0]) == 4);
+    assert(std::get<int>(sorted[4][0]) == -5);
+
+    // Signed zeros compare equal, so input order decides
+    TableData zeros = {{1, std::string("a"), 0.0}, {2, std::string("b"), -0.0}, {3, std::string("c"), 0.0}};
+    sorted = sorter.sort(zeros);
+    assert(std::get<int>(sorted[0][0]) == 1);
+    assert(std::get<int>(sorted[1][0]) == 2);
+    assert(std::get<int>(sorted[2][0]) == 3);
+
+    std::cout << "✓ Single column tests passed\n";
+}
+
+void test_multi_column() {
+    std::cout << "Testing multi column ordering...\n";
+    Schema schema = {{"department", STRING}, {"salary", DOUBLE}, {"id", INT}};
+    Sorter sorter(schema, {{0, ASCENDING}, {1, DESCENDING}});
+
+    TableData rows = {
+        {std::string("Sales"), 60000.0, 1},
+        {std::string("Eng"), 80000.0, 2},
+        {std::string("Engineering"), 70000.0, 3},
+        {std::string("Eng"), 90000.0, 4},
+        {std::string("Sales"), 60000.0, 5},
+        {std::string(""), 1.0, 6}
+    };
+
+    auto sorted = sorter.sort(rows);
+    std::vector<int> expected = {6, 4, 2, 3, 1, 5};
+    for (size_t i = 0; i < expected.size(); i++) {
+        assert(std::get<int>(sorted[i][2]) == expected[i]);
+    }
+
+    // Descending strings: longer strings sharing a prefix come first
+    Sorter byName(schema, {{0, DESCENDING}});
+    sorted = byName.sort(rows);
+    assert(std::get<std::string>(sorted[0][0]) == "Sales");
+    assert(std::get<std::string>(sorted[2][0]) == "Engineering");
+    assert(std::get<std::string>(sorted[5][0]) == "");
+
+    std::cout << "✓ Multi column tests passed\n";
+}
+
+RowSource sourceOf(const TableData& rows) {
+    return [&rows](const RowSink& add) {
+        for (const auto& row : rows) add(row);
+    };
+}
+
+TableData collect(Sorter& sorter, const TableData& rows, size_t limit = 0) {
+    TableData result;
+    assert(sorter.sort(sourceOf(rows), limit, [&result](const Row& row) { result.push_back(row); }));
+    return result;
+}
+
+bool leftoverRuns(const std::string& prefix) {
+    for (const auto& file : std::filesystem::directory_iterator(".")) {
+        if (file.path().filename().string().rfind(prefix, 0) == 0) return true;
+    }
+    return false;
+}
+
+void test_external_and_top_k() {
+    std::cout << "Testing external merge sort and top-K...\n";
+    Schema schema = {{"id", INT}, {"name", STRING}};
+
+    TableData rows;
+    for (int i = 0; i < 2000; i++) {
+        int key = (i * 7919) % 1000;
+        rows.push_back({key, std::string("row") + std::to_string(i)});
+    }
+
+    Sorter inMemory(schema, {{0, ASCENDING}});
+    Sorter external(schema, {{0, ASCENDING}}, 4096, "test_sorter");
+
+    auto expected = inMemory.sort(rows);
+    auto spilled = collect(external, rows);
+    assert(spilled.size() == rows.size());
+    assert(spilled == expected);
+
+    for (size_t i = 1; i < spilled.size(); i++) {
+        assert(std::get<int>(spilled[i - 1][0]) <= std::get<int>(spilled[i][0]));
+    }
+    assert(!leftoverRuns("test_sorter.sortrun."));
+
+    // Runs are on disk while the merge streams rows out
+    size_t streamed = 0;
+    assert(external.sort(sourceOf(rows), 0, [&](const Row& row) {
+        assert(streamed > 0 || leftoverRuns("test_sorter.sortrun."));
+        assert(row == expected[streamed++]);
+    }));
+    assert(streamed == rows.size());
+    assert(!leftoverRuns("test_sorter.sortrun."));
+
+    auto top = inMemory.sort(rows, 10);
+    assert(top.size() == 10);
+    for (size_t i = 0; i < top.size(); i++) {
+        assert(top[i] == expected[i]);
+    }
+
+    assert(external.sort(rows, 10) == top);
+    assert(collect(external, rows, 10) == top);
+
+    // Ties keep input order across runs
+    TableData ties;
+    for (int i = 0; i < 2000; i++) {
+        ties.push_back({i % 3, std::string("row") + std::to_string(i)});
+    }
+    assert(collect(external, ties) == inMemory.sort(ties));
+
+    // Strings longer than a page cannot be stored in a table page but must
+    // still come back from a spilled run
+    TableData wide;
+    for (int i = 0; i < 5; i++) {
+        wide.push_back({5 - i, std::string(i == 2 ? 3 * PAGE_SIZE : 10, 'a' + i)});
+    }
+    Sorter tiny(schema, {{0, ASCENDING}}, 1, "test_sorter");
+    auto wideSpilled = collect(tiny, wide);
+    assert(wideSpilled.size() == 5);
+    assert(wideSpilled == inMemory.sort(wide));
+    assert(std::get<std::string>(wideSpilled[2][1]).size() == 3 * PAGE_SIZE);
+
+    std::cout << "✓ External and top-K tests passed\n";
+}
+
+void test_concurrent_spills() {
+    std::cout << "Testing concurrent external sorts...\n";
+    Schema schema = {{"id", INT}, {"name", STRING}};
+
+    // Same spill prefix, as with concurrent orderBy calls on one table
+    std::vector<TableData> inputs(4), outputs(4);
+    for (int t = 0; t < 4; t++) {
+        for (int i = 0; i < 1500; i++) {
+            inputs[t].push_back({(i * 7919 + t) % 1000, std::string("t") + std::to_string(t)});
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            Sorter sorter(schema, {{0, ASCENDING}}, 2048, "test_sorter_shared");
+            outputs[t] = collect(sorter, inputs[t]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Sorter inMemory(schema, {{0, ASCENDING}});
+    for (int t = 0; t < 4; t++) {
+        assert(outputs[t] == inMemory.sort(inputs[t]));
+    }
+    assert(!leftoverRuns("test_sorter_shared.sortrun."));
+
+    std::cout << "✓ Concurrent external sort tests passed\n";
+}
+
+void test_table_order_by() {
+    std::cout << "Testing Table::orderBy...\n";
+    const std::string filename = "test_order_by.db";
+    Schema schema = {{"id", INT}, {"name", STRING}, {"salary", DOUBLE}};
+
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc, schema);
+        table.getRowStore().insert({1, std::string("Alice"), 50000.0});
+        table.getRowStore().insert({2, std::string("Bob"), 65000.0});
+        table.getRowStore().insert({3, std::string("Charlie"), 55000.0});
+
+        auto top = table.orderBy({{2, DESCENDING}}, 2);
+        assert(top.size() == 2);
+        assert(std::get<int>(top[0][0]) == 2);
+        assert(std::get<int>(top[1][0]) == 3);
+
+        table.setSortMemoryBudget(1);
+        auto all = table.orderBy({{1, DESCENDING}});
+        assert(all.size() == 3);
+        assert(std::get<std::string>(all[0][1]) == "Charlie");
+
+        assert(table.orderBy({{7, ASCENDING}}).empty());
+        assert(!table.orderBy({{7, ASCENDING}}, 0, [](const Row&) { assert(false); }));
+
+        std::vector<int> ids;
+        assert(table.orderBy({{2, ASCENDING}}, 0, [&ids](const Row& row) { ids.push_back(std::get<int>(row[0])); }));
+        assert((ids == std::vector<int>{1, 3, 2}));
+
+        for (int i = 4; i <= 2000; i++) {
+            table.getRowStore().insert({i, std::string("row") + std::to_string(i), (i * 7919) % 1000 * 1.0});
+        }
+        table.flush();
+    }
+
+    // Reopened without load(): rows are read page by page into the sort
+    {
+        Table table(filename, std::ios::in | std::ios::out | std::ios::binary);
+        table.setSortMemoryBudget(4096);
+
+        auto all = table.orderBy({{2, ASCENDING}, {0, ASCENDING}});
+        assert(all.size() == 2000);
+        for (size_t i = 1; i < all.size(); i++) {
+            assert(std::get<double>(all[i - 1][2]) <= std::get<double>(all[i][2]));
+        }
+        assert(!table.isLoaded());
+
+        auto top = table.orderBy({{0, DESCENDING}}, 3);
+        assert(top.size() == 3);
+        assert(std::get<int>(top[0][0]) == 2000);
+        assert(std::get<int>(top[2][0]) == 1998);
+        assert(!leftoverRuns(filename + ".sortrun."));
+    }
+
+    std::filesystem::remove(filename);
+    std::cout << "✓ Table::orderBy tests passed\n";
+}
+
+int main() {
+    std::cout << "\n=== Sorter Tests ===\n";
+    test_single_column();
+    test_multi_column();
+    test_external_and_top_k();
+    test_concurrent_spills();
+    test_table_order_by();
+    std::cout << "\n✓ All Sorter tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <cassert>
+#include <iostream>
+#include <filesystem>
+#include "../include/Table.hpp"
+#include "../include/TypedTable.hpp"
+
+using Employees = TypedTable<int, std::string, double>;
+
+void cleanup_test_files() {
+    std::filesystem::remove("test_typed.db");
+    std::filesystem::remove("test_typed_interop.db");
+}
+
+void test_metadata() {
+    std::cout << "Testing compile-time metadata...\n";
+
+    static_assert(Employees::columnCount == 3);
+    static_assert(Employees::columnTypes[0] == INT);
+    static_assert(Employees::columnTypes[1] == STRING);
+    static_assert(Employees::columnTypes[2] == DOUBLE);
+    static_assert(!Employees::fixedWidth);
+    static_assert(TypedTable<int, double>::fixedWidth);
+    static_assert(TypedTable<int, double>::fixedRowSize == sizeof(int) + sizeof(double));
+
+    std::cout << "✓ Metadata tests passed\n";
+}
+
+void test_crud_and_predicates() {
+    std::cout << "Testing typed CRUD and predicates...\n";
+    Employees table("test_typed.db", std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc,
+                    {"id", "name", "salary"});
+
+    table.insert({1, "Alice", 50000.0});
+    table.insert({2, "Bob", 65000.0});
+    table.insert({3, "Charlie", 55000.0});
+    assert(table.rowCount() == 3);
+
+    auto highEarners = table.selectWhere<2>([](double salary) { return salary > 52000.0; });
+    assert(highEarners.size() == 2);
+
+    size_t updated = table.updateWhere(
+        [](const auto& row) { return std::get<1>(row) == "Bob"; },
+        [](auto row) { std::get<2>(row) += 1000.0; return row; }
+    );
+    assert(updated == 1);
+    assert(std::get<2>(*table.getRow(1)) == 66000.0);
+
+    assert(table.deleteWhere([](const auto& row) { return std::get<0>(row) == 3; }) == 1);
+    assert(!table.getRow(2).has_value());
+
+    table.flush();
+    table.clear();
+    table.load();
+    assert(table.rowCount() == 2);
+    assert(std::get<1>(*table.getRow(0)) == "Alice");
+
+    std::cout << "✓ Typed CRUD tests passed\n";
+}
+
+void test_file_interchange() {
+    std::cout << "Testing typed/dynamic file interchange...\n";
+    const std::string filename = "test_typed_interop.db";
+
+    {
+        Employees typed(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc,
+                        {"id", "name", "salary"});
+        typed.insert({1, "Alice", 50000.0});
+        typed.insert({2, "Bob", 60000.0});
+        typed.flush();
+
+        Table dynamic(filename, std::ios::in | std::ios::out | std::ios::binary, typed.getSchema());
+        dynamic.load();
+        assert(dynamic.getRowStore().rowCount() == 2);
+        assert(std::get<std::string>((*dynamic.getRowStore().getRow(1))[1]) == "Bob");
+
+        dynamic.getRowStore().insert({3, std::string("Charlie"), 70000.0});
+        dynamic.flush();
+    }
+
+    {
+        Employees typed(filename, std::ios::in | std::ios::out | std::ios::binary, {"id", "name", "salary"});
+        assert(typed.load());
+        assert(typed.rowCount() == 3);
+        assert(std::get<1>(*typed.getRow(2)) == "Charlie");
+
+        Row row = Employees::toRow(*typed.getRow(2));
+        Employees::RowType back;
+        assert(Employees::fromRow(row, back));
+        assert(back == *typed.getRow(2));
+        assert(!Employees::fromRow({1, 2, 3}, back));
+    }
+
+    {
+        // Same column count, different types: refused rather than misdecoded
+        TypedTable<int, double, std::string> wrong(filename, std::ios::in | std::ios::out | std::ios::binary,
+                                                   {"id", "salary", "name"});
+        assert(!wrong.load());
+        assert(wrong.rowCount() == 0);
+
+        TypedTable<int, std::string> narrow(filename, std::ios::in | std::ios::out | std::ios::binary, {"id", "name"});
+        assert(!narrow.load());
+    }
+
+    std::cout << "✓ Interchange tests passed\n";
+}
+
+int main() {
+    std::cout << "\n=== TypedTable Tests ===\n";
+    cleanup_test_files();
+
+    test_metadata();
+    test_crud_and_predicates();
+    test_file_interchange();
+
+    cleanup_test_files();
+    std::cout << "\n✓ All TypedTable tests passed!\n";
+    return 0;
+}